@@ -0,0 +1,107 @@
+////////////////////////////////////////////////////////////
+// Virtual versus static dispatch of the receiver callbacks
+//
+// Runs real frames through both windows: runFrame() calls the observer
+// each window registered with its native window, exactly as the native
+// timer does. For sf::EmbeddedWindow that is the virtual onObservation and
+// the virtual EmbeddedWindowEventReceiver; for sf::BasicEmbeddedWindow it
+// is dispatch< Receiver > straight away. Both include beginFrame and
+// endFrame. The receivers only drain their events, so what differs between
+// the two is the cost of reaching them.
+//
+// Needs a display: each benchmark opens a small parent window.
+////////////////////////////////////////////////////////////
+
+#include <cstdint>
+#include <tuple>
+
+#include <benchmark/benchmark.h>
+
+#include <SFML/Graphics/RenderWindow.hpp>
+#include <SFML/Window/Event.hpp>
+#include <SFML/Window/Window.hpp>
+
+#include "SFML/Embedded/BasicEmbeddedWindow.hpp"
+#include "SFML/Embedded/EmbeddedWindowEventReceiver.hpp"
+
+namespace
+{
+
+////////////////////////////////////////////////////////////
+template < typename Base >
+class CountingReceiver : public Base
+{
+public:
+
+  uint64_t frames { 0 };
+
+  void onWindowCreated( const sf::EmbeddedWindow&, sf::RenderWindow& ) override {}
+  void onWindowDestroyed( const sf::EmbeddedWindow&, sf::RenderWindow& ) override {}
+  void onError() override {}
+
+  void onFrame( const sf::EmbeddedWindow&, sf::RenderWindow& window ) override
+  {
+    sf::Event event {};
+    while ( window.pollEvent( event ) )
+      ;
+
+    ++frames;
+  }
+};
+
+// not final, so every call goes through the vtable as it does for any receiver
+using VirtualReceiver = CountingReceiver< sf::EmbeddedWindowEventReceiver >;
+
+// final, so BasicEmbeddedWindow resolves the calls at compile time
+class StaticReceiver final : public CountingReceiver< sf::EmbeddedWindowEventReceiver >
+{
+};
+
+////////////////////////////////////////////////////////////
+/// runs frames on the calling thread until the benchmark is done
+void runFrames( benchmark::State& state, sf::EmbeddedWindow& window, const uint64_t& frames )
+{
+  // on Linux frames otherwise run on the frame thread, which owns the context
+  std::ignore = window.setHostDriven( true );
+
+  if ( !window.runFrame() )
+  {
+    state.SkipWithError( "the embedded window can't run frames" );
+    return;
+  }
+
+  for ( auto _ : state )
+    window.runFrame();
+
+  benchmark::DoNotOptimize( frames );
+  state.SetItemsProcessed( state.iterations() );
+}
+
+////////////////////////////////////////////////////////////
+void BM_VirtualDispatch( benchmark::State& state )
+{
+  sf::Window parent( sf::VideoMode( 320, 240 ), "dispatch benchmark" );
+
+  VirtualReceiver receiver;
+  sf::EmbeddedWindow window( parent.getSystemHandle(), receiver );
+
+  runFrames( state, window, receiver.frames );
+}
+
+////////////////////////////////////////////////////////////
+void BM_StaticDispatch( benchmark::State& state )
+{
+  sf::Window parent( sf::VideoMode( 320, 240 ), "dispatch benchmark" );
+
+  StaticReceiver receiver;
+  sf::BasicEmbeddedWindow< StaticReceiver > window( parent.getSystemHandle(), receiver );
+
+  runFrames( state, window, receiver.frames );
+}
+
+}
+
+BENCHMARK( BM_VirtualDispatch );
+BENCHMARK( BM_StaticDispatch );
+
+BENCHMARK_MAIN();
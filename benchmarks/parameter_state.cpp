@@ -0,0 +1,146 @@
+////////////////////////////////////////////////////////////
+// Contention between the audio thread and onFrame on EmbeddedParameterState
+//
+// A writer thread publishes a block of slots at audio-block rate (64
+// samples at 48kHz by default) while the main thread reads them at frame
+// rate, as a plugin and its editor do. Every block sets a quarter of the
+// slots to the block's number, so a snapshot that mixes two blocks shows
+// up as a torn read. Reports the worst write and read times, retries and
+// failed reads, and exits with an error on any torn read.
+//
+// usage: sfml-embedded-parameter-state-benchmark [seconds] [block interval in us, 0 is flat out] [frame interval in us]
+// e.g.   sfml-embedded-parameter-state-benchmark 10 0 16667
+////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+#include "SFML/Embedded/EmbeddedParameterState.hpp"
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::size_t SlotCount = 512;
+
+// every slot that is a multiple of this holds the block's number
+constexpr std::size_t CounterStride = 4;
+
+sf::EmbeddedParameterState< SlotCount > state;
+
+////////////////////////////////////////////////////////////
+int64_t getNanoseconds( Clock::duration duration )
+{
+  return std::chrono::duration_cast< std::chrono::nanoseconds >( duration ).count();
+}
+
+////////////////////////////////////////////////////////////
+/// \brief writes blocks until told to stop. returns the worst block time in ns
+int64_t runWriter( const std::atomic< bool >& isRunning, std::chrono::microseconds blockInterval )
+{
+  int64_t worst = 0;
+  float block = 0.f;
+  auto next = Clock::now();
+
+  while ( isRunning.load( std::memory_order_relaxed ) )
+  {
+    const auto start = Clock::now();
+
+    state.beginWrite();
+    for ( std::size_t slot = 0; slot < SlotCount; ++slot )
+      state.set( slot, slot % CounterStride == 0 ? block : static_cast< float >( slot ) );
+    state.endWrite();
+
+    worst = std::max( worst, getNanoseconds( Clock::now() - start ) );
+    block += 1.f;
+
+    if ( blockInterval.count() > 0 )
+    {
+      next += blockInterval;
+      std::this_thread::sleep_until( next );
+    }
+  }
+
+  return worst;
+}
+
+////////////////////////////////////////////////////////////
+/// \brief checks that every counter slot of a snapshot holds the same block
+bool isTorn( const sf::EmbeddedParameterSnapshot< SlotCount >& snapshot )
+{
+  const auto block = snapshot.get( 0 );
+  for ( std::size_t slot = CounterStride; slot < SlotCount; slot += CounterStride )
+  {
+    if ( snapshot.get( slot ) != block )
+      return true;
+  }
+
+  return false;
+}
+
+////////////////////////////////////////////////////////////
+long getArgument( int argc, char ** argv, int index, long fallback )
+{
+  return index < argc ? std::stol( argv[ index ] ) : fallback;
+}
+
+}
+
+int main( int argc, char ** argv )
+{
+  const auto duration = std::chrono::seconds( getArgument( argc, argv, 1, 10 ) );
+  const auto blockInterval = std::chrono::microseconds( getArgument( argc, argv, 2, 1333 ) );
+  const auto frameInterval = std::chrono::microseconds( getArgument( argc, argv, 3, 16667 ) );
+
+  std::atomic< bool > isRunning { true };
+  int64_t worstWrite = 0;
+  std::thread writer( [ & ] { worstWrite = runWriter( isRunning, blockInterval ); } );
+
+  sf::EmbeddedParameterSnapshot< SlotCount > snapshot;
+  uint64_t reads = 0;
+  uint64_t tornReads = 0;
+  int64_t worstRead = 0;
+
+  const auto end = Clock::now() + duration;
+  auto nextFrame = Clock::now();
+
+  while ( Clock::now() < end )
+  {
+    const auto start = Clock::now();
+    const auto isRead = state.read( snapshot );
+    worstRead = std::max( worstRead, getNanoseconds( Clock::now() - start ) );
+
+    if ( isRead )
+    {
+      ++reads;
+      if ( isTorn( snapshot ) )
+        ++tornReads;
+    }
+
+    nextFrame += frameInterval;
+    std::this_thread::sleep_until( nextFrame );
+  }
+
+  isRunning.store( false, std::memory_order_relaxed );
+  writer.join();
+
+  std::printf( "%zu slots, block every %lldus, frame every %lldus\n", SlotCount,
+               static_cast< long long >( blockInterval.count() ), static_cast< long long >( frameInterval.count() ) );
+  std::printf( "blocks written: %llu, worst write: %.1fus\n",
+               static_cast< unsigned long long >( state.getWriteCount() ), static_cast< double >( worstWrite ) / 1000.0 );
+  std::printf( "reads: %llu, retries: %llu, failed: %llu, torn: %llu, worst read: %.1fus\n",
+               static_cast< unsigned long long >( reads ),
+               static_cast< unsigned long long >( snapshot.getRetryCount() ),
+               static_cast< unsigned long long >( snapshot.getFailedReadCount() ),
+               static_cast< unsigned long long >( tornReads ),
+               static_cast< double >( worstRead ) / 1000.0 );
+
+  return tornReads == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,156 @@
+////////////////////////////////////////////////////////////
+// Input-to-display latency regression check
+//
+// Opens a parent window with an embedded child, injects a synthetic mouse
+// move every parent frame and fails when the measured percentile goes over
+// the limit. Injection goes through the host's message queue on Windows and
+// through the X server on Linux, which needs XInput2.
+//
+// usage: sfml-embedded-input-latency [limit in ms] [seconds] [percentile]
+// e.g.   sfml-embedded-input-latency 33 20 99
+////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <SFML/Graphics.hpp>
+#include <SFML/Embedded.hpp>
+
+namespace
+{
+
+////////////////////////////////////////////////////////////
+/// \brief Does what an editor frame does: drain the events, then draw and display
+////////////////////////////////////////////////////////////
+class LatencyReceiver : public sf::EmbeddedWindowEventReceiver
+{
+public:
+
+  void onWindowCreated( const sf::EmbeddedWindow& /*embeddedWindow*/, sf::RenderWindow& /*window*/ ) override
+  {
+    m_isCreated = true;
+
+    for ( std::size_t i = 0; i < m_knobs.size(); ++i )
+    {
+      m_knobs[ i ].setRadius( 18.f );
+      m_knobs[ i ].setPosition( { 20.f + 48.f * static_cast< float >( i % 8 ), 20.f + 48.f * static_cast< float >( i / 8 ) } );
+    }
+  }
+
+  void onWindowDestroyed( const sf::EmbeddedWindow& /*embeddedWindow*/, sf::RenderWindow& /*window*/ ) override
+  {
+    m_isCreated = false;
+  }
+
+  void onError() override
+  {
+    m_hasFailed = true;
+  }
+
+  void onFrame( const sf::EmbeddedWindow& /*embeddedWindow*/, sf::RenderWindow& window ) override
+  {
+    sf::Event event {};
+    while ( window.pollEvent( event ) )
+    {
+      if ( event.type == sf::Event::MouseMoved )
+        m_cursor = { static_cast< float >( event.mouseMove.x ), static_cast< float >( event.mouseMove.y ) };
+    }
+
+    window.clear( { 32, 32, 32 } );
+
+    for ( auto& knob : m_knobs )
+    {
+      knob.setFillColor( knob.getGlobalBounds().contains( m_cursor ) ? sf::Color::White : sf::Color( 96, 96, 96 ) );
+      window.draw( knob );
+    }
+
+    window.display();
+  }
+
+  [[nodiscard]]
+  bool isCreated() const { return m_isCreated; }
+
+  [[nodiscard]]
+  bool hasFailed() const { return m_hasFailed; }
+
+private:
+
+  std::vector< sf::CircleShape > m_knobs { 64 };
+  sf::Vector2f m_cursor;
+  bool m_isCreated { false };
+  bool m_hasFailed { false };
+};
+
+////////////////////////////////////////////////////////////
+float getArgument( int argc, char ** argv, int index, float fallback )
+{
+  return index < argc ? std::stof( argv[ index ] ) : fallback;
+}
+
+}
+
+int main( int argc, char ** argv )
+{
+  const auto limit = sf::microseconds( static_cast< sf::Int64 >( getArgument( argc, argv, 1, 33.f ) * 1000.f ) );
+  const auto duration = sf::seconds( getArgument( argc, argv, 2, 10.f ) );
+  const auto percentile = getArgument( argc, argv, 3, 99.f );
+
+  sf::Window parent( sf::VideoMode { 440, 440 }, "input latency" );
+  parent.setFramerateLimit( 60 );
+
+  LatencyReceiver receiver;
+  sf::EmbeddedWindow embeddedWindow( parent.getSystemHandle(), receiver );
+  embeddedWindow.setInputLatencyMeasurement( true );
+
+  if ( receiver.hasFailed() || !receiver.isCreated() )
+  {
+    std::fprintf( stderr, "the embedded window could not be created\n" );
+    return EXIT_FAILURE;
+  }
+
+  sf::Clock clock;
+  while ( parent.isOpen() && clock.getElapsedTime() < duration )
+  {
+    // the parent's pump also delivers the child's messages and frame timer
+    sf::Event event {};
+    while ( parent.pollEvent( event ) )
+    {
+      if ( event.type == sf::Event::Closed )
+        parent.close();
+    }
+
+    if ( !embeddedWindow.injectSyntheticInput() )
+    {
+      std::fprintf( stderr, "synthetic input is not supported on this platform\n" );
+      return EXIT_FAILURE;
+    }
+
+    parent.display();
+  }
+
+  // the histogram belongs to whichever thread runs the frames. stopping the
+  // frame thread (Linux) hands the frames, and the histogram, to this one
+  std::ignore = embeddedWindow.setHostDriven( true );
+
+  const auto& latency = embeddedWindow.getInputLatency();
+  const auto measured = latency.getPercentile( percentile );
+
+  std::printf( "%llu inputs: p50 %lldus, p%.0f %lldus, max %lldus (limit %lldus)\n",
+               static_cast< unsigned long long >( latency.getCount() ),
+               static_cast< long long >( latency.getPercentile( 50.f ).asMicroseconds() ),
+               percentile,
+               static_cast< long long >( measured.asMicroseconds() ),
+               static_cast< long long >( latency.getMax().asMicroseconds() ),
+               static_cast< long long >( limit.asMicroseconds() ) );
+
+  if ( latency.getCount() == 0 )
+  {
+    std::fprintf( stderr, "no input was measured\n" );
+    return EXIT_FAILURE;
+  }
+
+  return measured > limit ? EXIT_FAILURE : EXIT_SUCCESS;
+}
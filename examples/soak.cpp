@@ -0,0 +1,361 @@
+////////////////////////////////////////////////////////////
+// Lifecycle soak test
+//
+// 1. churn: opens and closes embedded windows one after the other, checking
+//    after every batch that EmbeddedDiagnostics is back to zero, and that
+//    the process' handles and memory stop growing after a warm-up.
+// 2. many: runs a large number of windows at once and checks that every
+//    one of them keeps rendering, and that the frame cost doesn't grow
+//    between the first and the second half of the run.
+//
+// Exits with an error on the first regression. On Linux, run it on a
+// virtual display against the X11 backend:
+//   xvfb-run -a -s "-screen 0 1280x1024x24" ./sfml-embedded-soak
+//
+// usage: sfml-embedded-soak [windows to churn] [windows at once] [seconds at once]
+////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <Psapi.h>
+#else
+#include <dirent.h>
+#include <unistd.h>
+#endif
+
+#include <SFML/Graphics.hpp>
+#include <SFML/Embedded.hpp>
+
+namespace
+{
+
+// growth tolerated after the warm-up. drivers keep some caches of their own
+constexpr int64_t MaxHandleGrowth = 16;
+constexpr int64_t MaxMemoryGrowth = 64 * 1024 * 1024;
+
+// how much slower the second half's frames may get
+constexpr float MaxFrameCostRatio = 2.f;
+const sf::Time FrameCostSlack = sf::milliseconds( 2 );
+
+constexpr uint32_t ChurnBatchSize = 100;
+const sf::Vector2u ChildSize { 64, 64 };
+
+////////////////////////////////////////////////////////////
+/// \brief Draws a little, counts its frames and keeps its p99 frame cost
+///
+/// Frames run on a frame thread on Linux, which is the only thread that
+/// may read the window's frame cost.
+////////////////////////////////////////////////////////////
+class SoakReceiver : public sf::EmbeddedWindowEventReceiver
+{
+public:
+
+  void onWindowCreated( const sf::EmbeddedWindow& /*embeddedWindow*/, sf::RenderWindow& /*window*/ ) override
+  {
+    m_shape.setSize( { 24.f, 24.f } );
+  }
+
+  void onWindowDestroyed( const sf::EmbeddedWindow& /*embeddedWindow*/, sf::RenderWindow& /*window*/ ) override
+  {}
+
+  void onError() override
+  {
+    m_hasFailed = true;
+  }
+
+  void onFrame( const sf::EmbeddedWindow& embeddedWindow, sf::RenderWindow& window ) override
+  {
+    sf::Event event {};
+    while ( window.pollEvent( event ) )
+    {}
+
+    m_shape.setPosition( { static_cast< float >( m_frames % 40 ), 20.f } );
+
+    window.clear( { 32, 32, 32 } );
+    window.draw( m_shape );
+    window.display();
+
+    m_frames.fetch_add( 1, std::memory_order_relaxed );
+    m_frameCostInUS.store( embeddedWindow.getFrameCost().getPercentile( 99.f ).asMicroseconds(),
+                           std::memory_order_relaxed );
+  }
+
+  [[nodiscard]]
+  uint64_t getFrameCount() const { return m_frames.load( std::memory_order_relaxed ); }
+
+  [[nodiscard]]
+  sf::Time getFrameCost() const { return sf::microseconds( m_frameCostInUS.load( std::memory_order_relaxed ) ); }
+
+  [[nodiscard]]
+  bool hasFailed() const { return m_hasFailed; }
+
+private:
+
+  sf::RectangleShape m_shape;
+
+  std::atomic< uint64_t > m_frames { 0 };
+  std::atomic< int64_t > m_frameCostInUS { 0 };
+  std::atomic< bool > m_hasFailed { false };
+};
+
+////////////////////////////////////////////////////////////
+struct SoakWindow
+{
+  SoakReceiver receiver;
+  std::unique_ptr< sf::EmbeddedWindow > window;
+};
+
+////////////////////////////////////////////////////////////
+/// \brief gets the number of handles (Windows) or file descriptors (Linux) held by the process
+int64_t getHandleCount()
+{
+#ifdef _WIN32
+  DWORD handles = 0;
+  ::GetProcessHandleCount( ::GetCurrentProcess(), &handles );
+  return static_cast< int64_t >( handles ) +
+         ::GetGuiResources( ::GetCurrentProcess(), GR_USEROBJECTS ) +
+         ::GetGuiResources( ::GetCurrentProcess(), GR_GDIOBJECTS );
+#else
+  int64_t count = 0;
+  if ( auto * directory = ::opendir( "/proc/self/fd" ) )
+  {
+    while ( ::readdir( directory ) != nullptr )
+      ++count;
+
+    ::closedir( directory );
+  }
+
+  return count;
+#endif
+}
+
+////////////////////////////////////////////////////////////
+/// \brief gets the memory committed by the process (Windows) or its resident size (Linux)
+int64_t getMemoryUsage()
+{
+#ifdef _WIN32
+  PROCESS_MEMORY_COUNTERS_EX counters {};
+  ::GetProcessMemoryInfo( ::GetCurrentProcess(),
+                          reinterpret_cast< PROCESS_MEMORY_COUNTERS * >( &counters ),
+                          sizeof( counters ) );
+  return static_cast< int64_t >( counters.PrivateUsage );
+#else
+  long pages = 0;
+  long resident = 0;
+  if ( auto * file = std::fopen( "/proc/self/statm", "r" ) )
+  {
+    if ( std::fscanf( file, "%ld %ld", &pages, &resident ) != 2 )
+      resident = 0;
+
+    std::fclose( file );
+  }
+
+  return static_cast< int64_t >( resident ) * ::sysconf( _SC_PAGESIZE );
+#endif
+}
+
+////////////////////////////////////////////////////////////
+/// \brief runs the parent's event loop, which also delivers the children's native events and timers
+void pump( sf::Window& parent, sf::Time duration )
+{
+  sf::Clock clock;
+
+  do
+  {
+    sf::Event event {};
+    while ( parent.pollEvent( event ) )
+    {}
+
+    sf::sleep( sf::milliseconds( 1 ) );
+  }
+  while ( clock.getElapsedTime() < duration );
+}
+
+////////////////////////////////////////////////////////////
+bool openWindow( sf::Window& parent, SoakWindow& soakWindow )
+{
+  soakWindow.window = std::make_unique< sf::EmbeddedWindow >( parent.getSystemHandle(),
+                                                              soakWindow.receiver,
+                                                              sf::ContextSettings {},
+                                                              ChildSize );
+
+  return !soakWindow.receiver.hasFailed();
+}
+
+////////////////////////////////////////////////////////////
+bool checkEverythingReleased( const char * when )
+{
+  static const char * names[ sf::E_ResourceCount ] { "render windows", "native windows", "window classes",
+                                                     "timers", "software framebuffers" };
+
+  if ( sf::EmbeddedDiagnostics::isEverythingReleased() && sf::EmbeddedMemoryAccount::getProcessTotal().getTotalBytes() == 0 )
+    return true;
+
+  std::fprintf( stderr, "resources leaked %s:\n", when );
+  for ( int i = 0; i < sf::E_ResourceCount; ++i )
+    std::fprintf( stderr, "  %s: %lld\n", names[ i ],
+                  static_cast< long long >( sf::EmbeddedDiagnostics::getLiveCount( static_cast< sf::E_EmbeddedResource >( i ) ) ) );
+
+  std::fprintf( stderr, "  accounted memory: %llu bytes\n",
+                static_cast< unsigned long long >( sf::EmbeddedMemoryAccount::getProcessTotal().getTotalBytes() ) );
+  return false;
+}
+
+////////////////////////////////////////////////////////////
+bool churn( sf::Window& parent, uint32_t count )
+{
+  std::printf( "churn: opening and closing %u windows\n", count );
+
+  int64_t baseHandles = 0;
+  int64_t baseMemory = 0;
+
+  for ( uint32_t i = 0; i < count; ++i )
+  {
+    {
+      SoakWindow soakWindow;
+      if ( !openWindow( parent, soakWindow ) )
+      {
+        std::fprintf( stderr, "window %u could not be created\n", i );
+        return false;
+      }
+
+      // long enough for a frame or two
+      pump( parent, sf::milliseconds( 20 ) );
+    }
+
+    if ( ( i + 1 ) % ChurnBatchSize != 0 )
+      continue;
+
+    if ( !checkEverythingReleased( ( "after " + std::to_string( i + 1 ) + " windows" ).c_str() ) )
+      return false;
+
+    const auto handles = getHandleCount();
+    const auto memory = getMemoryUsage();
+    std::printf( "  %u windows: %lld handles, %lld KB\n", i + 1,
+                 static_cast< long long >( handles ), static_cast< long long >( memory / 1024 ) );
+
+    // the first batch warms up the driver and the library's own caches
+    if ( i + 1 == ChurnBatchSize )
+    {
+      baseHandles = handles;
+      baseMemory = memory;
+      continue;
+    }
+
+    if ( handles - baseHandles > MaxHandleGrowth )
+    {
+      std::fprintf( stderr, "handles grew from %lld to %lld\n",
+                    static_cast< long long >( baseHandles ), static_cast< long long >( handles ) );
+      return false;
+    }
+
+    if ( memory - baseMemory > MaxMemoryGrowth )
+    {
+      std::fprintf( stderr, "memory grew from %lld KB to %lld KB\n",
+                    static_cast< long long >( baseMemory / 1024 ), static_cast< long long >( memory / 1024 ) );
+      return false;
+    }
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////
+/// \brief gets the worst p99 frame cost among the windows
+sf::Time getWorstFrameCost( const std::vector< std::unique_ptr< SoakWindow > >& windows )
+{
+  sf::Time worst;
+  for ( const auto& soakWindow : windows )
+    worst = std::max( worst, soakWindow->receiver.getFrameCost() );
+
+  return worst;
+}
+
+////////////////////////////////////////////////////////////
+bool runMany( sf::Window& parent, uint32_t count, sf::Time duration )
+{
+  std::printf( "many: running %u windows for %.0f seconds\n", count, duration.asSeconds() );
+
+  std::vector< std::unique_ptr< SoakWindow > > windows;
+  for ( uint32_t i = 0; i < count; ++i )
+  {
+    windows.push_back( std::make_unique< SoakWindow >() );
+    if ( !openWindow( parent, *windows.back() ) )
+    {
+      std::fprintf( stderr, "window %u of %u could not be created\n", i, count );
+      return false;
+    }
+  }
+
+  // the first frames pay for shader and texture setup
+  pump( parent, sf::seconds( 1 ) );
+  for ( auto& soakWindow : windows )
+    soakWindow->window->resetFrameCost();
+
+  pump( parent, duration / 2.f );
+  const auto firstHalf = getWorstFrameCost( windows );
+
+  std::vector< uint64_t > frameCounts;
+  for ( auto& soakWindow : windows )
+  {
+    soakWindow->window->resetFrameCost();
+    frameCounts.push_back( soakWindow->receiver.getFrameCount() );
+  }
+
+  pump( parent, duration / 2.f );
+  const auto secondHalf = getWorstFrameCost( windows );
+
+  std::printf( "  worst p99 frame cost: %lldus, then %lldus\n",
+               static_cast< long long >( firstHalf.asMicroseconds() ),
+               static_cast< long long >( secondHalf.asMicroseconds() ) );
+
+  for ( std::size_t i = 0; i < windows.size(); ++i )
+  {
+    if ( windows[ i ]->receiver.hasFailed() || windows[ i ]->receiver.getFrameCount() == frameCounts[ i ] )
+    {
+      std::fprintf( stderr, "window %zu stopped rendering\n", i );
+      return false;
+    }
+  }
+
+  if ( secondHalf > firstHalf * MaxFrameCostRatio + FrameCostSlack )
+  {
+    std::fprintf( stderr, "frames got slower over time\n" );
+    return false;
+  }
+
+  windows.clear();
+  return checkEverythingReleased( "after closing every window" );
+}
+
+////////////////////////////////////////////////////////////
+uint32_t getArgument( int argc, char ** argv, int index, uint32_t fallback )
+{
+  return index < argc ? static_cast< uint32_t >( std::stoul( argv[ index ] ) ) : fallback;
+}
+
+}
+
+int main( int argc, char ** argv )
+{
+  const auto churnCount = std::max( getArgument( argc, argv, 1, 2000 ), ChurnBatchSize );
+  const auto manyCount = getArgument( argc, argv, 2, 200 );
+  const auto manyDuration = sf::seconds( static_cast< float >( getArgument( argc, argv, 3, 60 ) ) );
+
+  sf::Window parent( sf::VideoMode { 800, 600 }, "sfml-embedded soak" );
+
+  if ( !churn( parent, churnCount ) || !runMany( parent, manyCount, manyDuration ) )
+    return EXIT_FAILURE;
+
+  std::printf( "no regressions\n" );
+  return EXIT_SUCCESS;
+}
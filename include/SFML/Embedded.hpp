@@ -1,9 +1,19 @@
 #pragma once
 #include "SFML/Embedded/EmbeddedWindow.hpp"
+#include "SFML/Embedded/BasicEmbeddedWindow.hpp"
+#include "SFML/Embedded/EmbeddedRemoteWindow.hpp"
+#include "SFML/Embedded/EmbeddedRemoteRenderer.hpp"
 #include "SFML/Embedded/EmbeddedWindowEventReceiver.hpp"
+#include "SFML/Embedded/EmbeddedViewportCompositor.hpp"
 
 #ifdef SFML_EMBEDDED_LOGGING
 #include <spdlog/spdlog.h>
 #endif
 
 #include "SFML/Embedded/EmbeddedLogger.hpp"
+#include "SFML/Embedded/EmbeddedTracer.hpp"
+#include "SFML/Embedded/EmbeddedDiagnostics.hpp"
+#include "SFML/Embedded/EmbeddedInputRecording.hpp"
+#include "SFML/Embedded/EmbeddedSoftwareCanvas.hpp"
+#include "SFML/Embedded/EmbeddedParameterState.hpp"
+#include "SFML/Embedded/EmbeddedMemoryAccount.hpp"
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "SFML/Embedded/EmbeddedWindow.hpp"
+
+namespace sf
+{
+
+////////////////////////////////////////////////////////////
+/// \brief EmbeddedWindow whose receiver type is bound at compile time
+///
+/// sf::EmbeddedWindow reaches its receiver through the virtual
+/// onObservation and the virtual EmbeddedWindowEventReceiver callbacks.
+/// BasicEmbeddedWindow skips both: the native window calls straight into
+/// a function generated for Receiver, so frame and event dispatch can be
+/// inlined into the receiver's own code.
+///
+/// Receiver needs the same member functions as EmbeddedWindowEventReceiver
+/// (onWindowCreated, onWindowDestroyed, onError and onFrame), but does not
+/// have to derive from it. If it does, mark it final so that the calls
+/// are devirtualized.
+///
+/// \code
+/// class MyReceiver final : public sf::EmbeddedWindowEventReceiver { ... };
+///
+/// MyReceiver receiver;
+/// sf::BasicEmbeddedWindow< MyReceiver > window( parentHandle, receiver );
+/// \endcode
+////////////////////////////////////////////////////////////
+template < typename Receiver >
+class BasicEmbeddedWindow : public EmbeddedWindow
+{
+public:
+
+  /// \brief Constructs a BasicEmbeddedWindow object
+  /// \param parentHandle Native handle of the parent window
+  /// \param receiver Event recipient (used for event callbacks)
+  /// \param contextSettings SFML context settings
+  /// \param startingSize starting window size (default is parent's window size)
+  BasicEmbeddedWindow( WindowHandle parentHandle,
+                       Receiver& receiver,
+                       const sf::ContextSettings& contextSettings = sf::ContextSettings {},
+                       const sf::Vector2u& startingSize = { 0, 0 } )
+    : m_receiver( receiver )
+  {
+    create( parentHandle, contextSettings, startingSize, &BasicEmbeddedWindow::observe, this );
+  }
+
+  /// \brief destroys the platform-specific embedded window
+  ~BasicEmbeddedWindow() override
+  {
+    // onWindowDestroyed must be dispatched while this object still exists
+    destroy();
+  }
+
+  /// \brief gets the receiver bound to this window
+  [[nodiscard]]
+  Receiver& getReceiver() const { return m_receiver; }
+
+private:
+
+  static void observe( void * context, E_EmbeddedWindowEventState state )
+  {
+    auto * self = static_cast< BasicEmbeddedWindow * >( context );
+    self->dispatch( self->m_receiver, state );
+  }
+
+private:
+
+  Receiver& m_receiver;
+};
+
+}
@@ -0,0 +1,269 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <SFML/System/Time.hpp>
+#include <SFML/Graphics/Font.hpp>
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/Texture.hpp>
+
+#include "SFML/Embedded/EmbeddedMemoryAccount.hpp"
+
+namespace sf
+{
+
+enum E_EmbeddedAssetState
+{
+  E_AssetLoading,     // waiting to be decoded or uploaded
+  E_AssetReady,       // usable. the real asset is returned from now on
+  E_AssetFailed       // could not be loaded. the placeholder stays in use
+};
+
+////////////////////////////////////////////////////////////
+/// \brief Handle to a texture that is loaded in the background
+///
+/// The handle can be drawn immediately: until the texture has been fully
+/// uploaded, getTexture() returns a 1x1 transparent placeholder. Reset any
+/// sprite rects (sprite.setTexture( asset->getTexture(), true )) once
+/// isReady() turns true.
+////////////////////////////////////////////////////////////
+class EmbeddedTextureAsset
+{
+public:
+
+  /// \brief gets the loaded texture or the placeholder. render thread only.
+  [[nodiscard]]
+  const sf::Texture& getTexture() const;
+
+  /// \brief gets the size of the image, which is known once it has been decoded
+  [[nodiscard]]
+  sf::Vector2u getSize() const;
+
+  [[nodiscard]]
+  E_EmbeddedAssetState getState() const { return m_state.load( std::memory_order_acquire ); }
+
+  [[nodiscard]]
+  bool isReady() const { return getState() == E_AssetReady; }
+
+  [[nodiscard]]
+  bool hasFailed() const { return getState() == E_AssetFailed; }
+
+private:
+
+  friend class EmbeddedAssetLoader;
+
+  std::atomic< E_EmbeddedAssetState > m_state { E_AssetLoading };
+  std::atomic< uint32_t > m_width { 0 };
+  std::atomic< uint32_t > m_height { 0 };
+
+  bool m_smooth { false };
+  sf::Texture m_texture;
+  std::shared_ptr< sf::Texture > m_placeholder;
+
+  // the texture's bytes, charged to the loader's account until the handle goes away
+  EmbeddedMemoryCharge m_textureCharge;
+};
+
+////////////////////////////////////////////////////////////
+/// \brief Handle to a font that is loaded in the background
+///
+/// Until the font is ready, getFont() returns an empty font, so text using
+/// it draws nothing rather than blocking the frame.
+////////////////////////////////////////////////////////////
+class EmbeddedFontAsset
+{
+public:
+
+  /// \brief gets the loaded font or an empty font. render thread only.
+  [[nodiscard]]
+  const sf::Font& getFont() const;
+
+  [[nodiscard]]
+  E_EmbeddedAssetState getState() const { return m_state.load( std::memory_order_acquire ); }
+
+  [[nodiscard]]
+  bool isReady() const { return getState() == E_AssetReady; }
+
+  [[nodiscard]]
+  bool hasFailed() const { return getState() == E_AssetFailed; }
+
+private:
+
+  friend class EmbeddedAssetLoader;
+
+  std::atomic< E_EmbeddedAssetState > m_state { E_AssetLoading };
+
+  // sf::Font reads from this buffer for as long as the font lives
+  std::vector< char > m_fileData;
+  sf::Font m_font;
+  EmbeddedMemoryCharge m_fileDataCharge;
+
+  inline static const sf::Font smEmptyFont {};
+};
+
+////////////////////////////////////////////////////////////
+/// \brief Loads images and fonts without blocking the render thread
+///
+/// Files are decoded on a small worker pool. Decoded images are then
+/// uploaded to the GPU on the render thread, a few rows at a time, within a
+/// per-frame time budget. A large filmstrip is therefore spread over several
+/// frames instead of causing a single long hitch.
+///
+/// Each EmbeddedWindow owns one loader (see EmbeddedWindow::getAssetLoader),
+/// which performs the uploads right before onFrame.
+////////////////////////////////////////////////////////////
+class EmbeddedAssetLoader
+{
+public:
+
+  EmbeddedAssetLoader();
+
+  /// \brief stops the worker pool. pending loads are abandoned and fail.
+  ~EmbeddedAssetLoader();
+
+  EmbeddedAssetLoader( const EmbeddedAssetLoader& ) = delete;
+  EmbeddedAssetLoader& operator=( const EmbeddedAssetLoader& ) = delete;
+
+  ////////////////////////////////////////////////////////////
+  /// \brief Queues a texture to be loaded from a file. Any thread.
+  /// \param filename image file (anything sf::Image can decode)
+  /// \param smooth enables smoothing on the texture once it is created
+  /// \return handle that can be drawn immediately
+  ////////////////////////////////////////////////////////////
+  std::shared_ptr< EmbeddedTextureAsset > loadTexture( const std::string& filename, bool smooth = false );
+
+  ////////////////////////////////////////////////////////////
+  /// \brief Queues a texture to be loaded from memory, e.g., an embedded resource. Any thread.
+  /// \param data encoded image. must stay valid until the handle is ready or has failed
+  /// \param size size of data in bytes
+  /// \param smooth enables smoothing on the texture once it is created
+  /// \return handle that can be drawn immediately
+  ////////////////////////////////////////////////////////////
+  std::shared_ptr< EmbeddedTextureAsset > loadTextureFromMemory( const void * data,
+                                                                 std::size_t size,
+                                                                 bool smooth = false );
+
+  ////////////////////////////////////////////////////////////
+  /// \brief Queues a font to be loaded from a file. Any thread.
+  /// \param filename font file (anything sf::Font can open)
+  /// \return handle that can be used immediately
+  ////////////////////////////////////////////////////////////
+  std::shared_ptr< EmbeddedFontAsset > loadFont( const std::string& filename );
+
+  /// \brief sets the number of decoding threads. only takes effect before the first load.
+  void setWorkerCount( uint32_t count );
+
+  /// \brief sets the account that textures and decoded images are charged to. only before the first load
+  void setMemoryAccount( std::shared_ptr< EmbeddedMemoryAccount > account );
+
+  /// \brief sets how much time per frame may be spent uploading textures. Any thread.
+  void setUploadBudget( sf::Time budget );
+
+  [[nodiscard]]
+  sf::Time getUploadBudget() const { return sf::microseconds( m_uploadBudgetInUS.load( std::memory_order_relaxed ) ); }
+
+  /// \brief gets the number of assets that have not finished loading yet
+  [[nodiscard]]
+  std::size_t getPendingCount() const { return m_pendingCount.load( std::memory_order_relaxed ); }
+
+  ////////////////////////////////////////////////////////////
+  /// \brief Uploads decoded images until the upload budget is spent.
+  ///
+  /// Called by EmbeddedWindow before each frame. Render thread only.
+  ////////////////////////////////////////////////////////////
+  void processUploads();
+
+  ////////////////////////////////////////////////////////////
+  /// \brief Stops the workers and releases every texture the loader still holds.
+  ///
+  /// Pending loads are abandoned and fail. Called by EmbeddedWindow while its
+  /// GL context is still active, right before the render window closes.
+  /// Textures of ready handles belong to whoever holds the handles; drop them
+  /// in onWindowDestroyed. Render thread only.
+  ////////////////////////////////////////////////////////////
+  void release();
+
+private:
+
+  /// a decoded image waiting for (or in the middle of) its upload
+  struct PendingUpload
+  {
+    std::shared_ptr< EmbeddedTextureAsset > asset;
+    sf::Image image;
+    uint32_t nextRow { 0 };
+    bool created { false };
+
+    // the decoded image, until it has been uploaded
+    EmbeddedMemoryCharge imageCharge;
+  };
+
+  /// a loaded font waiting to be handed to the render thread
+  struct PendingFont
+  {
+    std::shared_ptr< EmbeddedFontAsset > asset;
+  };
+
+  /// a load waiting for a worker
+  struct PendingJob
+  {
+    std::function< void() > decode;
+
+    // the asset's state, so that a job that never runs can fail it. the
+    // asset is kept alive by the decode function
+    std::atomic< E_EmbeddedAssetState > * state { nullptr };
+  };
+
+  void enqueueJob( std::atomic< E_EmbeddedAssetState >& state, std::function< void() > decode );
+  void ensureWorkersStarted();
+  void stopWorkers();
+  void runWorker();
+
+  /// hands a decoded image over to the render thread
+  void submitImage( const std::shared_ptr< EmbeddedTextureAsset >& asset, sf::Image&& image );
+
+  void fail( const std::shared_ptr< EmbeddedTextureAsset >& asset );
+
+  /// uploads as many rows as the time left allows. returns true once the upload is complete
+  bool uploadSlice( PendingUpload& upload, sf::Time timeLeft );
+
+private:
+
+  // bytes uploaded per texture update call. the budget is checked between calls
+  static constexpr std::size_t SliceSizeInBytes = 256 * 1024;
+
+  std::shared_ptr< sf::Texture > m_placeholder;
+
+  // null when nothing is accounted for
+  std::shared_ptr< EmbeddedMemoryAccount > m_memoryAccount;
+
+  // set from any thread, read by the render thread
+  std::atomic< int64_t > m_uploadBudgetInUS { 4000 };
+  std::atomic< std::size_t > m_pendingCount { 0 };
+
+  // worker pool
+  std::mutex m_jobMutex;
+  std::condition_variable m_jobCondition;
+  std::deque< PendingJob > m_jobs;
+  std::vector< std::thread > m_workers;
+  uint32_t m_workerCount { 2 };
+  bool m_stopping { false };
+
+  // decoded assets handed over to the render thread
+  std::mutex m_uploadMutex;
+  std::deque< PendingUpload > m_uploads;
+  std::deque< PendingFont > m_fonts;
+
+  // the upload currently being sliced. only touched by the render thread
+  std::unique_ptr< PendingUpload > m_currentUpload;
+};
+
+}
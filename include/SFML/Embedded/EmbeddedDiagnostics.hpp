@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace sf
+{
+
+enum E_EmbeddedResource
+{
+  E_ResourceRenderWindow,        // render windows (and their GL contexts) created by EmbeddedWindow
+  E_ResourceNativeWindow,        // native child windows
+  E_ResourceWindowClass,         // registered native window classes
+  E_ResourceTimer,               // running frame timers
+  E_ResourceSoftwareFramebuffer, // framebuffers of windows that render in software
+  E_ResourceCount
+};
+
+////////////////////////////////////////////////////////////
+/// \brief Process-wide counts of the native resources held by the library
+///
+/// Every count goes back to zero once all embedded windows are destroyed.
+/// A soak test can open and close windows for hours and compare the counts
+/// (and the process' own handle and memory usage) against a baseline.
+////////////////////////////////////////////////////////////
+class EmbeddedDiagnostics
+{
+public:
+
+  /// \brief gets the number of resources of a kind that are alive right now
+  [[nodiscard]]
+  static int64_t getLiveCount( E_EmbeddedResource resource )
+  {
+    return smLive[ resource ].load( std::memory_order_relaxed );
+  }
+
+  /// \brief gets the number of resources of a kind ever created
+  [[nodiscard]]
+  static uint64_t getCreatedCount( E_EmbeddedResource resource )
+  {
+    return smCreated[ resource ].load( std::memory_order_relaxed );
+  }
+
+  /// \brief checks whether every resource has been released
+  [[nodiscard]]
+  static bool isEverythingReleased()
+  {
+    for ( int i = 0; i < E_ResourceCount; ++i )
+    {
+      if ( smLive[ i ].load( std::memory_order_relaxed ) != 0 )
+        return false;
+    }
+
+    return true;
+  }
+
+  /// \brief counts a resource as created. used by the implementation
+  static void acquire( E_EmbeddedResource resource )
+  {
+    smLive[ resource ].fetch_add( 1, std::memory_order_relaxed );
+    smCreated[ resource ].fetch_add( 1, std::memory_order_relaxed );
+  }
+
+  /// \brief counts a resource as released. used by the implementation
+  static void release( E_EmbeddedResource resource )
+  {
+    smLive[ resource ].fetch_sub( 1, std::memory_order_relaxed );
+  }
+
+private:
+
+  inline static std::atomic< int64_t > smLive[ E_ResourceCount ] {};
+  inline static std::atomic< uint64_t > smCreated[ E_ResourceCount ] {};
+};
+
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+namespace sf
+{
+
+////////////////////////////////////////////////////////////
+/// \brief Bump allocator that is reset after every frame
+///
+/// Short-lived allocations made during onFrame (vertex lists, formatted
+/// labels, hit-test lists) are carved out of a single preallocated buffer
+/// and all released at once after onFrame returns, instead of going
+/// through the global heap.
+///
+/// If a frame needs more than the buffer holds, the extra allocations fall
+/// back to the heap. The buffer is then grown to the high-water mark when
+/// the arena is reset, so steady-state frames make no heap allocations.
+///
+/// Anything allocated from the arena must not outlive the frame.
+///
+/// \code
+/// sf::FrameVector< sf::Vertex > vertices( &embeddedWindow.getFrameArena() );
+/// sf::FrameString label( "gain: ", &embeddedWindow.getFrameArena() );
+/// \endcode
+////////////////////////////////////////////////////////////
+class EmbeddedFrameArena : public std::pmr::memory_resource
+{
+public:
+
+  ////////////////////////////////////////////////////////////
+  /// \brief Constructs the arena and preallocates its buffer
+  /// \param initialCapacity size of the buffer in bytes
+  /// \param upstream where the buffer and the overflow blocks come from.
+  /// must outlive the arena
+  ////////////////////////////////////////////////////////////
+  explicit EmbeddedFrameArena( std::size_t initialCapacity,
+                               std::pmr::memory_resource * upstream = std::pmr::new_delete_resource() );
+
+  ~EmbeddedFrameArena() override;
+
+  EmbeddedFrameArena( const EmbeddedFrameArena& ) = delete;
+  EmbeddedFrameArena& operator=( const EmbeddedFrameArena& ) = delete;
+
+  ////////////////////////////////////////////////////////////
+  /// \brief Releases everything allocated since the last reset
+  ///
+  /// Called by EmbeddedWindow after every onFrame. Grows the buffer if
+  /// the frame overflowed it.
+  ////////////////////////////////////////////////////////////
+  void reset();
+
+  /// \brief gets a PMR allocator that allocates from this arena
+  [[nodiscard]]
+  std::pmr::polymorphic_allocator< std::byte > getAllocator() { return { this }; }
+
+  /// \brief gets the size of the preallocated buffer in bytes
+  [[nodiscard]]
+  std::size_t getCapacity() const { return m_capacity; }
+
+  /// \brief gets the number of bytes allocated during the current frame (including overflow)
+  [[nodiscard]]
+  std::size_t getUsedBytes() const { return m_offset + m_overflowBytes; }
+
+  /// \brief gets the largest number of bytes a single frame has needed
+  [[nodiscard]]
+  std::size_t getHighWaterMark() const { return m_highWaterMark; }
+
+  /// \brief gets the number of allocations that had to fall back to the heap
+  [[nodiscard]]
+  uint64_t getOverflowCount() const { return m_overflowCount; }
+
+protected:
+
+  void * do_allocate( std::size_t bytes, std::size_t alignment ) override;
+
+  void do_deallocate( void * ptr, std::size_t bytes, std::size_t alignment ) override;
+
+  [[nodiscard]]
+  bool do_is_equal( const std::pmr::memory_resource& other ) const noexcept override;
+
+private:
+
+  // heap block used when the buffer is exhausted. freed on reset.
+  struct OverflowBlock
+  {
+    OverflowBlock * next;
+    std::size_t size;
+    std::size_t alignment;
+    void * memory;
+  };
+
+  void releaseOverflow();
+
+private:
+
+  // the buffer's alignment. anything stricter is aligned within it
+  static constexpr std::size_t BufferAlignment = alignof( std::max_align_t );
+
+  std::pmr::memory_resource * m_upstream;
+
+  std::byte * m_buffer { nullptr };
+  std::size_t m_capacity { 0 };
+  std::size_t m_offset { 0 };
+
+  OverflowBlock * m_overflow { nullptr };
+  std::size_t m_overflowBytes { 0 };
+  uint64_t m_overflowCount { 0 };
+
+  std::size_t m_highWaterMark { 0 };
+};
+
+/// vector whose storage comes from an EmbeddedFrameArena
+template < typename T >
+using FrameVector = std::pmr::vector< T >;
+
+/// string whose storage comes from an EmbeddedFrameArena
+using FrameString = std::pmr::string;
+
+}
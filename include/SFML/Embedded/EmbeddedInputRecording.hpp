@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <SFML/System/Time.hpp>
+#include <SFML/System/Vector2.hpp>
+
+namespace sf
+{
+
+enum E_EmbeddedReplayMode
+{
+  E_ReplayRealTime,         // frames are replayed at the pace they were recorded
+  E_ReplayAsFastAsPossible  // every frame replays the next recorded frame
+};
+
+////////////////////////////////////////////////////////////
+/// \brief A native input message as it reached the child window
+///
+/// Replayed through the same native window, it produces the same
+/// sf::Events. Pointer positions are relative to the window.
+////////////////////////////////////////////////////////////
+struct EmbeddedRecordedInput
+{
+  uint32_t message { 0 };
+  uint64_t wParam { 0 };
+  int64_t lParam { 0 };
+};
+
+////////////////////////////////////////////////////////////
+/// \brief State of the window at the start of a recorded frame
+////////////////////////////////////////////////////////////
+struct EmbeddedRecordedFrame
+{
+  sf::Time time;              // since the recording started
+  sf::Vector2i cursor;        // what getCursorPosition() returned
+  sf::Vector2u size;          // size of the render window
+  uint32_t firstInput { 0 };  // input that arrived since the previous frame
+  uint32_t inputCount { 0 };
+};
+
+////////////////////////////////////////////////////////////
+/// \brief Input of an editing session, recorded frame by frame
+///
+/// Record a real session with EmbeddedWindow::startRecording, save it,
+/// and replay it with EmbeddedWindow::startReplay to benchmark the same
+/// session (knob sweeps, resizes, preset browsing) again and again.
+///
+/// Files are a compact binary format: varint, delta-encoded records
+/// behind a small header. They are only meant to be replayed on the
+/// platform they were recorded on.
+////////////////////////////////////////////////////////////
+class EmbeddedInputRecording
+{
+public:
+
+  /// \brief forgets everything recorded
+  void clear();
+
+  /// \brief writes the recording to a file
+  /// \return false if the file couldn't be written
+  bool saveToFile( const std::string& filename ) const;
+
+  /// \brief replaces the recording with the contents of a file
+  ///
+  /// Files that hold messages a recording never captures (see
+  /// isRecordedMessage) are rejected, since replaying sends them to the
+  /// window as they are.
+  ///
+  /// \return false if the file couldn't be read or isn't a recording
+  bool loadFromFile( const std::string& filename );
+
+  [[nodiscard]]
+  const std::vector< EmbeddedRecordedFrame >& getFrames() const { return m_frames; }
+
+  [[nodiscard]]
+  const std::vector< EmbeddedRecordedInput >& getInputs() const { return m_inputs; }
+
+  /// \brief gets the time of the last recorded frame
+  [[nodiscard]]
+  sf::Time getDuration() const { return m_frames.empty() ? sf::Time::Zero : m_frames.back().time; }
+
+  /// \brief adds a native input message. used while recording
+  void addInput( const EmbeddedRecordedInput& input ) { m_inputs.push_back( input ); }
+
+  /// \brief closes a frame over the input added since the previous one. used while recording
+  void addFrame( sf::Time time, const sf::Vector2i& cursor, const sf::Vector2u& size );
+
+  /// \brief checks whether a native message is one that recordings capture (and replay)
+  [[nodiscard]]
+  static bool isRecordedMessage( uint32_t message );
+
+private:
+
+  std::vector< EmbeddedRecordedFrame > m_frames;
+  std::vector< EmbeddedRecordedInput > m_inputs;
+};
+
+}
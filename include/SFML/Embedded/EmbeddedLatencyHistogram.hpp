@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include <SFML/System/Time.hpp>
+
+namespace sf
+{
+
+////////////////////////////////////////////////////////////
+/// \brief Distribution of latency samples
+///
+/// Samples are counted in fixed 100us buckets up to 100ms (anything
+/// slower lands in the last bucket), so recording never allocates.
+/// Percentiles are accurate to one bucket; min, max and mean are exact.
+////////////////////////////////////////////////////////////
+class EmbeddedLatencyHistogram
+{
+public:
+
+  static constexpr uint32_t BucketCount = 1000;
+  static constexpr int64_t BucketWidthInUS = 100;
+
+  /// \brief records one sample
+  void add( sf::Time latency );
+
+  /// \brief forgets every sample
+  void reset();
+
+  /// \brief gets the number of samples
+  [[nodiscard]]
+  uint64_t getCount() const { return m_count; }
+
+  [[nodiscard]]
+  sf::Time getMin() const;
+
+  [[nodiscard]]
+  sf::Time getMax() const;
+
+  [[nodiscard]]
+  sf::Time getMean() const;
+
+  ////////////////////////////////////////////////////////////
+  /// \brief gets the latency that the given share of samples stays under
+  /// \param percentile between 0 and 100, e.g. 99 for the p99
+  /// \return upper bound of the bucket holding the percentile (capped at the max)
+  ////////////////////////////////////////////////////////////
+  [[nodiscard]]
+  sf::Time getPercentile( float percentile ) const;
+
+  /// \brief gets the number of samples in a bucket
+  [[nodiscard]]
+  uint32_t getBucket( uint32_t index ) const { return index < BucketCount ? m_buckets[ index ] : 0; }
+
+private:
+
+  std::array< uint32_t, BucketCount > m_buckets {};
+  uint64_t m_count { 0 };
+  int64_t m_totalInUS { 0 };
+  int64_t m_minInUS { 0 };
+  int64_t m_maxInUS { 0 };
+};
+
+}
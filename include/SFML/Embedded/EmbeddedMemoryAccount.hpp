@@ -0,0 +1,146 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace sf
+{
+
+enum E_EmbeddedMemoryKind
+{
+  E_MemoryFramebuffer,         // default framebuffer of the render window (GPU, estimated)
+  E_MemoryRenderTextures,      // render textures, such as the compositor's viewports (GPU)
+  E_MemoryTextures,            // textures loaded through the asset loader (GPU)
+  E_MemorySoftwareFramebuffer, // framebuffer of software frames (CPU)
+  E_MemoryHeap,                // frame arena, decoded images waiting for upload, font files (CPU)
+  E_MemoryKindCount
+};
+
+////////////////////////////////////////////////////////////
+/// \brief Bytes held by one account, per kind of memory
+////////////////////////////////////////////////////////////
+struct EmbeddedMemoryUsage
+{
+  std::string label; // only filled in by the process-wide reports
+  std::array< uint64_t, E_MemoryKindCount > bytes {};
+  uint64_t budget { 0 };
+
+  [[nodiscard]]
+  uint64_t getGpuBytes() const;
+
+  [[nodiscard]]
+  uint64_t getCpuBytes() const;
+
+  [[nodiscard]]
+  uint64_t getTotalBytes() const { return getGpuBytes() + getCpuBytes(); }
+};
+
+////////////////////////////////////////////////////////////
+/// \brief Memory attributed to one embedded window
+///
+/// Every EmbeddedWindow owns one. Its framebuffers, the textures of its
+/// asset loader and compositor, and its heap caches are charged to it, so
+/// that getProcessReport() tells which window holds what. GPU sizes are
+/// computed from texture sizes and formats; drivers add padding and
+/// alignment on top.
+///
+/// The counts are atomics, so charges can be made from any thread.
+////////////////////////////////////////////////////////////
+class EmbeddedMemoryAccount
+{
+public:
+
+  EmbeddedMemoryAccount();
+
+  ~EmbeddedMemoryAccount();
+
+  EmbeddedMemoryAccount( const EmbeddedMemoryAccount& ) = delete;
+  EmbeddedMemoryAccount& operator=( const EmbeddedMemoryAccount& ) = delete;
+
+  /// \brief names the account in reports. render thread only
+  void setLabel( const std::string& label );
+
+  /// \brief sets the number of bytes over which the owner is asked to shed caches (0 is no budget)
+  void setBudget( uint64_t bytes ) { m_budget.store( bytes, std::memory_order_relaxed ); }
+
+  [[nodiscard]]
+  uint64_t getBudget() const { return m_budget.load( std::memory_order_relaxed ); }
+
+  /// \brief checks whether a budget is set and the account went over it
+  [[nodiscard]]
+  bool isOverBudget() const;
+
+  [[nodiscard]]
+  uint64_t getBytes( E_EmbeddedMemoryKind kind ) const { return m_bytes[ kind ].load( std::memory_order_relaxed ); }
+
+  /// \brief gets the bytes of every kind at once
+  [[nodiscard]]
+  EmbeddedMemoryUsage getUsage() const;
+
+  /// \brief charges bytes to the account. used by the implementation
+  void add( E_EmbeddedMemoryKind kind, uint64_t bytes ) { m_bytes[ kind ].fetch_add( bytes, std::memory_order_relaxed ); }
+
+  /// \brief releases bytes charged earlier. used by the implementation
+  void release( E_EmbeddedMemoryKind kind, uint64_t bytes ) { m_bytes[ kind ].fetch_sub( bytes, std::memory_order_relaxed ); }
+
+  /// \brief checks whether a kind of memory lives on the GPU
+  [[nodiscard]]
+  static bool isGpuMemory( E_EmbeddedMemoryKind kind );
+
+  /// \brief gets the usage of every account alive in the process
+  [[nodiscard]]
+  static std::vector< EmbeddedMemoryUsage > getProcessReport();
+
+  /// \brief gets the usage of every account alive in the process, added up
+  [[nodiscard]]
+  static EmbeddedMemoryUsage getProcessTotal();
+
+private:
+
+  std::array< std::atomic< uint64_t >, E_MemoryKindCount > m_bytes {};
+  std::atomic< uint64_t > m_budget { 0 };
+
+  // guarded by the registry's mutex, since reports read it from any thread
+  std::string m_label;
+};
+
+////////////////////////////////////////////////////////////
+/// \brief Bytes charged to an account for as long as the charge lives
+///
+/// Holds on to the account, so resources that outlive their window (e.g.
+/// asset handles kept by a receiver) still release their bytes correctly.
+////////////////////////////////////////////////////////////
+class EmbeddedMemoryCharge
+{
+public:
+
+  EmbeddedMemoryCharge() = default;
+
+  EmbeddedMemoryCharge( std::shared_ptr< EmbeddedMemoryAccount > account, E_EmbeddedMemoryKind kind );
+
+  ~EmbeddedMemoryCharge() { setBytes( 0 ); }
+
+  EmbeddedMemoryCharge( EmbeddedMemoryCharge&& other ) noexcept;
+  EmbeddedMemoryCharge& operator=( EmbeddedMemoryCharge&& other ) noexcept;
+
+  EmbeddedMemoryCharge( const EmbeddedMemoryCharge& ) = delete;
+  EmbeddedMemoryCharge& operator=( const EmbeddedMemoryCharge& ) = delete;
+
+  /// \brief charges the difference to what was charged so far. ignored without an account
+  void setBytes( uint64_t bytes );
+
+  [[nodiscard]]
+  uint64_t getBytes() const { return m_bytes; }
+
+private:
+
+  std::shared_ptr< EmbeddedMemoryAccount > m_account;
+  E_EmbeddedMemoryKind m_kind { E_MemoryHeap };
+  uint64_t m_bytes { 0 };
+};
+
+}
@@ -0,0 +1,267 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace sf
+{
+
+////////////////////////////////////////////////////////////
+/// \brief A consistent copy of an EmbeddedParameterState, owned by a reader
+///
+/// Also tells which slots changed since the reader's previous snapshot, so
+/// that widgets whose values didn't change don't have to be redrawn. The
+/// first snapshot marks every slot as changed.
+////////////////////////////////////////////////////////////
+template < std::size_t SlotCount >
+class EmbeddedParameterSnapshot
+{
+public:
+
+  static constexpr std::size_t MaskWordCount = ( SlotCount + 63 ) / 64;
+
+  /// \brief gets the value of a slot
+  [[nodiscard]]
+  float get( std::size_t slot ) const;
+
+  /// \brief checks whether a slot changed with the last successful read
+  [[nodiscard]]
+  bool hasChanged( std::size_t slot ) const
+  {
+    return ( m_changed[ slot / 64 ] >> ( slot % 64 ) & 1 ) != 0;
+  }
+
+  /// \brief checks whether any slot changed with the last successful read
+  [[nodiscard]]
+  bool hasAnyChanged() const;
+
+  /// \brief gets 64 change bits. slot n is bit n % 64 of word n / 64
+  [[nodiscard]]
+  uint64_t getChangedMask( std::size_t word ) const { return m_changed[ word ]; }
+
+  /// \brief gets the number of times a read raced the writer and started over
+  [[nodiscard]]
+  uint64_t getRetryCount() const { return m_retryCount; }
+
+  /// \brief gets the number of reads that gave up and kept the previous snapshot
+  [[nodiscard]]
+  uint64_t getFailedReadCount() const { return m_failedReadCount; }
+
+private:
+
+  template < std::size_t >
+  friend class EmbeddedParameterState;
+
+  std::array< uint32_t, SlotCount > m_values {};
+  std::array< uint32_t, SlotCount > m_reading {};
+  std::array< uint64_t, MaskWordCount > m_changed {};
+  bool m_isValid { false };
+
+  uint64_t m_retryCount { 0 };
+  uint64_t m_failedReadCount { 0 };
+};
+
+////////////////////////////////////////////////////////////
+/// \brief Fixed block of float slots shared between the audio thread and onFrame
+///
+/// Parameters and meter values that belong together are written as one
+/// block under a sequence lock. A single writer (the audio thread) never
+/// waits and never allocates: a block is two stores to the sequence and a
+/// store per changed slot. Readers copy the whole block and start over if
+/// the sequence moved while they copied, so a snapshot never mixes values
+/// of two blocks. Any number of readers can read, each into its own
+/// snapshot.
+///
+/// The slots are atomics accessed with relaxed ordering, which makes the
+/// copy free of data races; the fences around the sequence order them.
+///
+/// \code
+/// // audio thread, once per block
+/// state.beginWrite();
+/// state.set( Gain, gain );
+/// state.set( PeakLeft, peakLeft );
+/// state.set( PeakRight, peakRight );
+/// state.endWrite();
+///
+/// // onFrame
+/// if ( state.read( m_snapshot ) && m_snapshot.hasChanged( Gain ) )
+///   m_gainKnob.setValue( m_snapshot.get( Gain ) );
+/// \endcode
+////////////////////////////////////////////////////////////
+template < std::size_t SlotCount >
+class EmbeddedParameterState
+{
+public:
+
+  using Snapshot = EmbeddedParameterSnapshot< SlotCount >;
+
+  /// a read gives up after this many races with the writer
+  static constexpr uint32_t MaxReadAttempts = 8;
+
+  EmbeddedParameterState() = default;
+
+  EmbeddedParameterState( const EmbeddedParameterState& ) = delete;
+  EmbeddedParameterState& operator=( const EmbeddedParameterState& ) = delete;
+
+  [[nodiscard]]
+  static constexpr std::size_t getSlotCount() { return SlotCount; }
+
+  ////////////////////////////////////////////////////////////
+  /// WRITER. one thread only
+  ////////////////////////////////////////////////////////////
+
+  /// \brief starts a block of writes. readers that overlap it start over
+  void beginWrite();
+
+  /// \brief sets a slot. only between beginWrite and endWrite
+  void set( std::size_t slot, float value );
+
+  /// \brief publishes the block of writes
+  void endWrite();
+
+  /// \brief sets a single slot as a block of its own
+  void store( std::size_t slot, float value );
+
+  ////////////////////////////////////////////////////////////
+  /// READERS
+  ////////////////////////////////////////////////////////////
+
+  ////////////////////////////////////////////////////////////
+  /// \brief Copies the slots into a snapshot and marks the ones that changed
+  ///
+  /// Never blocks the writer. A read that keeps racing the writer gives up
+  /// after MaxReadAttempts and leaves the snapshot as it was, with nothing
+  /// marked as changed; the next frame reads again.
+  ///
+  /// \return false if the snapshot was left as it was
+  ////////////////////////////////////////////////////////////
+  bool read( Snapshot& snapshot ) const;
+
+  /// \brief gets the number of blocks written so far
+  [[nodiscard]]
+  uint64_t getWriteCount() const { return m_sequence.load( std::memory_order_relaxed ) / 2; }
+
+private:
+
+  [[nodiscard]]
+  static uint32_t toBits( float value );
+
+  // odd while a block is being written. on a cache line of its own, since
+  // every reader polls it
+  alignas( 64 ) std::atomic< uint64_t > m_sequence { 0 };
+
+  alignas( 64 ) std::array< std::atomic< uint32_t >, SlotCount > m_values {};
+};
+
+////////////////////////////////////////////////////////////
+template < std::size_t SlotCount >
+float EmbeddedParameterSnapshot< SlotCount >::get( std::size_t slot ) const
+{
+  float value;
+  std::memcpy( &value, &m_values[ slot ], sizeof( value ) );
+  return value;
+}
+
+////////////////////////////////////////////////////////////
+template < std::size_t SlotCount >
+bool EmbeddedParameterSnapshot< SlotCount >::hasAnyChanged() const
+{
+  for ( const auto word : m_changed )
+  {
+    if ( word != 0 )
+      return true;
+  }
+
+  return false;
+}
+
+////////////////////////////////////////////////////////////
+template < std::size_t SlotCount >
+void EmbeddedParameterState< SlotCount >::beginWrite()
+{
+  const auto sequence = m_sequence.load( std::memory_order_relaxed );
+  m_sequence.store( sequence + 1, std::memory_order_relaxed );
+
+  // the odd sequence becomes visible before any of the slots
+  std::atomic_thread_fence( std::memory_order_release );
+}
+
+////////////////////////////////////////////////////////////
+template < std::size_t SlotCount >
+void EmbeddedParameterState< SlotCount >::set( std::size_t slot, float value )
+{
+  // only the writer stores, so it can skip slots that keep their value
+  const auto bits = toBits( value );
+  if ( m_values[ slot ].load( std::memory_order_relaxed ) != bits )
+    m_values[ slot ].store( bits, std::memory_order_relaxed );
+}
+
+////////////////////////////////////////////////////////////
+template < std::size_t SlotCount >
+void EmbeddedParameterState< SlotCount >::endWrite()
+{
+  const auto sequence = m_sequence.load( std::memory_order_relaxed );
+  m_sequence.store( sequence + 1, std::memory_order_release );
+}
+
+////////////////////////////////////////////////////////////
+template < std::size_t SlotCount >
+void EmbeddedParameterState< SlotCount >::store( std::size_t slot, float value )
+{
+  beginWrite();
+  set( slot, value );
+  endWrite();
+}
+
+////////////////////////////////////////////////////////////
+template < std::size_t SlotCount >
+bool EmbeddedParameterState< SlotCount >::read( Snapshot& snapshot ) const
+{
+  for ( uint32_t attempt = 0; attempt < MaxReadAttempts; ++attempt )
+  {
+    const auto before = m_sequence.load( std::memory_order_acquire );
+    if ( ( before & 1 ) == 0 )
+    {
+      for ( std::size_t slot = 0; slot < SlotCount; ++slot )
+        snapshot.m_reading[ slot ] = m_values[ slot ].load( std::memory_order_relaxed );
+
+      // the copy is done before the sequence is checked again
+      std::atomic_thread_fence( std::memory_order_acquire );
+      if ( m_sequence.load( std::memory_order_relaxed ) == before )
+      {
+        snapshot.m_changed.fill( 0 );
+        for ( std::size_t slot = 0; slot < SlotCount; ++slot )
+        {
+          if ( !snapshot.m_isValid || snapshot.m_reading[ slot ] != snapshot.m_values[ slot ] )
+            snapshot.m_changed[ slot / 64 ] |= uint64_t( 1 ) << ( slot % 64 );
+        }
+
+        snapshot.m_values = snapshot.m_reading;
+        snapshot.m_isValid = true;
+        return true;
+      }
+    }
+
+    ++snapshot.m_retryCount;
+  }
+
+  ++snapshot.m_failedReadCount;
+  snapshot.m_changed.fill( 0 );
+  return false;
+}
+
+////////////////////////////////////////////////////////////
+template < std::size_t SlotCount >
+uint32_t EmbeddedParameterState< SlotCount >::toBits( float value )
+{
+  static_assert( sizeof( float ) == sizeof( uint32_t ) );
+
+  uint32_t bits;
+  std::memcpy( &bits, &value, sizeof( bits ) );
+  return bits;
+}
+
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <string>
+
+#include "SFML/Embedded/EmbeddedWindow.hpp"
+
+namespace sf
+{
+
+////////////////////////////////////////////////////////////
+/// \brief Helper-side half of an EmbeddedRemoteWindow
+///
+/// Runs the receiver in the helper process. The render window is a hidden
+/// top-level window whose drawing is redirected into a render texture
+/// (see EmbeddedWindow::setRenderingOffscreen), so receivers draw to it as
+/// usual. After every onFrame the texture is read straight into the shared
+/// frame the host presents next, unless the receiver called keepLastFrame().
+/// Frames rendered in software are not published. Input forwarded by the
+/// host is replayed into the render window, so receivers keep polling
+/// sf::Events as usual, and getCursorPosition() reports the cursor over the
+/// host's presenter window.
+///
+/// The size of the frames is fixed by the host when the helper is launched
+/// (see EmbeddedRemoteWindow).
+////////////////////////////////////////////////////////////
+class EmbeddedRemoteRenderer : public EmbeddedWindow
+{
+public:
+
+  /// command line argument the host uses to pass the channel name
+  static constexpr const char * ChannelArgument = "--sfml-embedded-channel=";
+
+  /// \brief gets the channel name from the helper's command line
+  /// \return the channel name or an empty string if it isn't there
+  static std::string findChannelName( int argc, char ** argv );
+
+  /// \brief Connects to the host and creates the render window
+  /// \param channelName channel passed by the host (see findChannelName)
+  /// \param embeddedWindowEvent Event recipient (used for event callbacks)
+  /// \param contextSettings SFML context settings
+  EmbeddedRemoteRenderer( const std::string& channelName,
+                          EmbeddedWindowEventReceiver& embeddedWindowEvent,
+                          const sf::ContextSettings& contextSettings = sf::ContextSettings {} );
+
+  /// \brief destroys the render window
+  ~EmbeddedRemoteRenderer() override;
+
+  ////////////////////////////////////////////////////////////
+  /// \brief Runs the helper until the host closes the channel or exits
+  /// \return exit code for the helper process
+  ////////////////////////////////////////////////////////////
+  int run();
+
+private:
+
+  static void observe( void * context, E_EmbeddedWindowEventState state );
+
+private:
+
+  EmbeddedWindowEventReceiver& m_receiver;
+
+  // owned by EmbeddedWindow
+  priv::EmbeddedWindowImpl * m_remoteImpl { nullptr };
+};
+
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include <SFML/System/Time.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <SFML/Window/WindowHandle.hpp>
+
+// forward declaration
+namespace sf::priv
+{
+class EmbeddedRemotePresenter;
+}
+
+namespace sf
+{
+
+////////////////////////////////////////////////////////////
+/// \brief Frame statistics of an EmbeddedRemoteWindow
+////////////////////////////////////////////////////////////
+struct EmbeddedRemoteStats
+{
+  uint64_t publishedFrames { 0 };   // frames rendered by the helper
+  uint64_t presentedFrames { 0 };   // frames shown by the host
+  uint64_t droppedInputs { 0 };     // input messages lost because the helper fell behind
+  sf::Time lastLatency;             // time from publish (helper) to present (host)
+  sf::Time averageLatency;
+  sf::Time maxLatency;
+  bool isHelperRunning { false };
+};
+
+////////////////////////////////////////////////////////////
+/// \brief Host-side presenter for an editor that renders in a helper process
+///
+/// The editor (the EmbeddedWindowEventReceiver) runs in a separate helper
+/// executable built around sf::EmbeddedRemoteRenderer. The helper renders
+/// offscreen and publishes frames through a shared-memory triple buffer.
+/// This window only shows the newest frame and forwards input back to the
+/// helper, so a crash or a GPU stall in the editor cannot take the host down.
+///
+/// The size is fixed when the window is created: the shared frames, the
+/// host's bitmaps and the helper's render window are all allocated for it
+/// once, and nothing follows the parent when it is resized. To change the
+/// size, destroy the EmbeddedRemoteWindow and create a new one, which
+/// restarts the helper. Helpers whose receiver calls keepLastFrame() when
+/// nothing changed don't read back or publish those frames.
+///
+/// \code
+/// // in the plugin (host process)
+/// m_editor = std::make_unique< sf::EmbeddedRemoteWindow >( parentHandle, "C:/path/to/editor-helper.exe" );
+///
+/// // in editor-helper.exe
+/// int main( int argc, char ** argv )
+/// {
+///   MyReceiver receiver;
+///   sf::EmbeddedRemoteRenderer renderer( sf::EmbeddedRemoteRenderer::findChannelName( argc, argv ), receiver );
+///   return renderer.run();
+/// }
+/// \endcode
+////////////////////////////////////////////////////////////
+class EmbeddedRemoteWindow
+{
+public:
+
+  /// \brief Creates the presenter window and launches the helper process
+  /// \param parentHandle Native handle of the parent window
+  /// \param helperPath path to the helper executable
+  /// \param size size of the window and its frames, fixed from then on (default is parent's window size)
+  EmbeddedRemoteWindow( WindowHandle parentHandle,
+                        const std::string& helperPath,
+                        const sf::Vector2u& size = { 0, 0 } );
+
+  /// \brief asks the helper to exit (terminating it if it doesn't) and destroys the window
+  ~EmbeddedRemoteWindow();
+
+  EmbeddedRemoteWindow( const EmbeddedRemoteWindow& ) = delete;
+  EmbeddedRemoteWindow& operator=( const EmbeddedRemoteWindow& ) = delete;
+
+  /// \brief gets the native handle of the presenter window
+  [[nodiscard]]
+  WindowHandle getSystemHandle() const;
+
+  /// \brief gets the native handle of the presenter window's parent
+  [[nodiscard]]
+  WindowHandle getParentSystemHandle() const;
+
+  /// \brief checks whether the helper process is still alive
+  [[nodiscard]]
+  bool isHelperRunning() const;
+
+  /// \brief gets frame and latency statistics
+  [[nodiscard]]
+  EmbeddedRemoteStats getStats() const;
+
+private:
+
+  // platform-specific presenter
+  priv::EmbeddedRemotePresenter * m_impl { nullptr };
+};
+
+}
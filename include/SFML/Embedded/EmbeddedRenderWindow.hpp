@@ -0,0 +1,40 @@
+#pragma once
+
+#include <SFML/Graphics/RenderTexture.hpp>
+#include <SFML/Graphics/RenderWindow.hpp>
+
+namespace sf::priv
+{
+
+////////////////////////////////////////////////////////////
+/// \brief The render window handed to receivers, which can draw offscreen
+///
+/// With an offscreen target, every activation binds the target's
+/// framebuffer in the window's context, so that everything drawn to the
+/// window (including after drawing to other render textures) lands in the
+/// target instead. The window itself is never shown and its default
+/// framebuffer is never used. See EmbeddedRemoteRenderer.
+////////////////////////////////////////////////////////////
+class EmbeddedRenderWindow : public sf::RenderWindow
+{
+public:
+
+  ////////////////////////////////////////////////////////////
+  /// \brief redirects the window's drawing into a render texture of the same size
+  /// \param target the render texture, or null to draw to the window again.
+  /// must stay alive until it is replaced
+  ////////////////////////////////////////////////////////////
+  void setOffscreenTarget( sf::RenderTexture * target );
+
+  [[nodiscard]]
+  sf::RenderTexture * getOffscreenTarget() const { return m_offscreenTarget; }
+
+  /// \brief activates the window's context, and binds the offscreen target's framebuffer if there is one
+  bool setActive( bool active = true ) override;
+
+private:
+
+  sf::RenderTexture * m_offscreenTarget { nullptr };
+};
+
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+
+namespace sf
+{
+
+enum E_EmbeddedSoftwareFallback
+{
+  E_SoftwareFallbackOff,        // always render with OpenGL
+  E_SoftwareFallbackOnFailure,  // render in software when there is no OpenGL context
+  E_SoftwareFallbackWhenSlow,   // also when OpenGL frames keep going over budget
+  E_SoftwareFallbackAlways      // always render in software
+};
+
+////////////////////////////////////////////////////////////
+/// \brief Draws the usual 2D primitives into a CPU framebuffer
+///
+/// Used when an editor renders in software, see EmbeddedWindow::
+/// setSoftwareFallback. The canvas draws straight into the memory the
+/// native window presents from, so nothing is copied between drawing
+/// and presenting.
+///
+/// Rows of spans are filled and alpha blended four pixels at a time with
+/// SSE2 where available. Edges are not anti-aliased.
+////////////////////////////////////////////////////////////
+class EmbeddedSoftwareCanvas
+{
+public:
+
+  EmbeddedSoftwareCanvas() = default;
+
+  /// \brief wraps a framebuffer of 32-bit BGRX pixels
+  /// \param pixels first pixel of the top row
+  /// \param size size in pixels
+  /// \param stride distance between rows, in pixels
+  EmbeddedSoftwareCanvas( uint32_t * pixels, const sf::Vector2u& size, uint32_t stride );
+
+  [[nodiscard]]
+  sf::Vector2u getSize() const { return m_size; }
+
+  [[nodiscard]]
+  uint32_t * getPixels() const { return m_pixels; }
+
+  [[nodiscard]]
+  uint32_t getStride() const { return m_stride; }
+
+  /// \brief restricts drawing to an area of the canvas
+  void setClip( const sf::IntRect& clip );
+
+  /// \brief allows drawing to the whole canvas again
+  void resetClip();
+
+  [[nodiscard]]
+  sf::IntRect getClip() const { return m_clip; }
+
+  /// \brief fills the clip area, ignoring the color's alpha
+  void clear( const sf::Color& color = sf::Color::Black );
+
+  /// \brief fills a rectangle
+  void fillRect( const sf::IntRect& rect, const sf::Color& color );
+
+  /// \brief draws the outline of a rectangle, inside of it
+  void drawRect( const sf::IntRect& rect, const sf::Color& color, int thickness = 1 );
+
+  /// \brief fills a circle
+  void fillCircle( const sf::Vector2f& center, float radius, const sf::Color& color );
+
+  /// \brief fills a convex polygon. the points may go either way around
+  void fillConvexPolygon( const sf::Vector2f * points, std::size_t count, const sf::Color& color );
+
+  /// \brief draws a line as a filled quad
+  void drawLine( const sf::Vector2f& from, const sf::Vector2f& to, float thickness, const sf::Color& color );
+
+  /// \brief blends an image with its own alpha
+  void drawImage( const sf::Image& image, const sf::Vector2i& position );
+
+  /// \brief blends part of an image with its own alpha
+  void drawImage( const sf::Image& image, const sf::Vector2i& position, const sf::IntRect& sourceRect );
+
+private:
+
+  /// fills the pixels [left, right) of a row, clipped
+  void fillSpan( int y, int left, int right, const sf::Color& color );
+
+private:
+
+  uint32_t * m_pixels { nullptr };
+  sf::Vector2u m_size;
+  uint32_t m_stride { 0 };
+  sf::IntRect m_clip;
+};
+
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include <SFML/System/Time.hpp>
+
+namespace sf
+{
+
+////////////////////////////////////////////////////////////
+/// \brief Bounded multi-producer, single-consumer task queue
+///
+/// All nodes are allocated up front, so posting a task never touches the
+/// heap and never takes a lock. Producers reserve a node with a single CAS
+/// (bounded MPMC queue by D. Vyukov, used here with one consumer), which
+/// makes posting safe from real-time threads.
+///
+/// Tasks are stored inline in the node, so the callable (including its
+/// captures) must fit in TaskStorageSize bytes. Copying/moving the callable
+/// into the node must not allocate either if the caller needs RT-safety,
+/// i.e., capture PODs and pointers, not std::string or std::vector.
+////////////////////////////////////////////////////////////
+class EmbeddedTaskQueue
+{
+public:
+
+  /// size of the inline storage available to a single task
+  static constexpr std::size_t TaskStorageSize = 64;
+
+  /// \brief Constructs the queue and preallocates all of its nodes
+  /// \param capacity number of nodes. rounded up to a power of 2.
+  explicit EmbeddedTaskQueue( std::size_t capacity );
+
+  ~EmbeddedTaskQueue();
+
+  EmbeddedTaskQueue( const EmbeddedTaskQueue& ) = delete;
+  EmbeddedTaskQueue& operator=( const EmbeddedTaskQueue& ) = delete;
+
+  ////////////////////////////////////////////////////////////
+  /// \brief Adds a task to the queue. Can be called from any thread.
+  ///
+  /// Never allocates and never blocks.
+  ///
+  /// \param task any callable with the signature void()
+  /// \return false if the queue is full
+  ////////////////////////////////////////////////////////////
+  template < typename Task >
+  bool push( Task&& task );
+
+  ////////////////////////////////////////////////////////////
+  /// \brief Runs queued tasks. Must only be called from the consumer thread.
+  ///
+  /// At least one task is run (if any are queued) so that the queue always
+  /// makes progress, even with a zero budget.
+  ///
+  /// An exception thrown by a task propagates out of drain(). The task's
+  /// node is released first, so the queue keeps working afterwards.
+  ///
+  /// \param budget stop running tasks once this much time has elapsed
+  /// \param maxTasks stop running tasks once this many have been run
+  /// \return the number of tasks that were run
+  ////////////////////////////////////////////////////////////
+  std::size_t drain( sf::Time budget, std::size_t maxTasks );
+
+  /// \brief gets the number of preallocated nodes
+  [[nodiscard]]
+  std::size_t getCapacity() const { return m_mask + 1; }
+
+  /// \brief gets the number of tasks rejected because the queue was full
+  [[nodiscard]]
+  uint64_t getDroppedCount() const { return m_dropped.load( std::memory_order_relaxed ); }
+
+private:
+
+  struct Node
+  {
+    std::atomic< std::size_t > sequence { 0 };
+    void ( *invoke )( void * storage ) { nullptr };
+    void ( *destroy )( void * storage ) { nullptr };
+    alignas( std::max_align_t ) unsigned char storage[ TaskStorageSize ];
+  };
+
+  template < typename Fn >
+  static void invokeTask( void * storage ) { ( *static_cast< Fn * >( storage ) )(); }
+
+  template < typename Fn >
+  static void destroyTask( void * storage ) { static_cast< Fn * >( storage )->~Fn(); }
+
+  /// reserves the next free node or returns nullptr if the queue is full
+  Node * reserve( std::size_t& position );
+
+private:
+
+  std::unique_ptr< Node[] > m_nodes;
+  std::size_t m_mask { 0 };
+
+  // producers and the consumer live on separate cache lines
+  alignas( 64 ) std::atomic< std::size_t > m_enqueuePosition { 0 };
+  std::atomic< uint64_t > m_dropped { 0 };
+
+  alignas( 64 ) std::size_t m_dequeuePosition { 0 };
+};
+
+////////////////////////////////////////////////////////////
+template < typename Task >
+bool EmbeddedTaskQueue::push( Task&& task )
+{
+  using Fn = std::decay_t< Task >;
+
+  static_assert( sizeof( Fn ) <= TaskStorageSize,
+                 "task is too large for EmbeddedTaskQueue. capture less or capture by pointer." );
+  static_assert( alignof( Fn ) <= alignof( std::max_align_t ),
+                 "task is over-aligned for EmbeddedTaskQueue" );
+  static_assert( std::is_invocable_r_v< void, Fn& >,
+                 "task must be callable with the signature void()" );
+  // a throwing constructor would leave a reserved node that is never published
+  static_assert( std::is_nothrow_constructible_v< Fn, Task&& >,
+                 "task must be nothrow constructible. move it into post() instead of copying it." );
+
+  std::size_t position = 0;
+  Node * node = reserve( position );
+
+  if ( node == nullptr )
+  {
+    m_dropped.fetch_add( 1, std::memory_order_relaxed );
+    return false;
+  }
+
+  new ( node->storage ) Fn( std::forward< Task >( task ) );
+  node->invoke = &invokeTask< Fn >;
+  node->destroy = &destroyTask< Fn >;
+
+  // publish the node to the consumer
+  node->sequence.store( position + 1, std::memory_order_release );
+  return true;
+}
+
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#ifdef SFML_EMBEDDED_TRACING
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace sf
+{
+
+////////////////////////////////////////////////////////////
+/// \brief Records the frame lifecycle and dumps it as a Chrome trace
+///
+/// Every thread records into its own fixed-size ring, so recording never
+/// takes a lock or allocates after the first event on a thread. When a
+/// ring is full the oldest events are overwritten. Threads only get a ring
+/// once they record their first event. The ring of a thread that exited is
+/// kept for dumps until a new thread takes it over, or clear() frees it.
+/// Use the TRACE_* macros
+/// rather than calling this directly so that the calls disappear when
+/// SFML_EMBEDDED_TRACING isn't defined.
+///
+/// The JSON written by writeChromeTrace can be opened in chrome://tracing
+/// or https://ui.perfetto.dev
+////////////////////////////////////////////////////////////
+class EmbeddedTracer
+{
+public:
+
+  /// events kept per thread
+  static constexpr uint32_t EventsPerThread = 8192;
+
+  /// \brief starts or stops recording. recording is off by default
+  static void setEnabled( bool enabled );
+
+  /// \brief checks whether events are being recorded
+  [[nodiscard]]
+  static bool isEnabled()
+  {
+    return smEnabled.load( std::memory_order_relaxed );
+  }
+
+  /// \brief names the calling thread in the trace. doesn't allocate anything
+  /// \param name must outlive the tracer (use a string literal)
+  static void setThreadName( const char * name );
+
+  /// \brief records a zero-length event
+  /// \param name must outlive the tracer (use a string literal)
+  static void instant( const char * name );
+
+  /// \brief records an event that spans start to end
+  /// \param name must outlive the tracer (use a string literal)
+  static void complete( const char * name, int64_t start, int64_t end );
+
+  /// \brief gets the current time in the tracer's clock (nanoseconds)
+  [[nodiscard]]
+  static int64_t now()
+  {
+    return std::chrono::duration_cast< std::chrono::nanoseconds >(
+      std::chrono::steady_clock::now().time_since_epoch() ).count();
+  }
+
+  /// \brief gets every recorded event as Chrome trace JSON
+  [[nodiscard]]
+  static std::string getChromeTrace();
+
+  /// \brief writes every recorded event to a Chrome trace JSON file
+  /// \return false if the file couldn't be written
+  static bool writeChromeTrace( const std::string& filename );
+
+  /// \brief forgets every recorded event and frees the rings of exited threads
+  static void clear();
+
+private:
+
+  inline static std::atomic< bool > smEnabled { false };
+};
+
+////////////////////////////////////////////////////////////
+/// \brief Records the lifetime of a scope. See TRACE_SCOPE
+////////////////////////////////////////////////////////////
+class EmbeddedTraceScope
+{
+public:
+
+  explicit EmbeddedTraceScope( const char * name )
+    : m_name( EmbeddedTracer::isEnabled() ? name : nullptr ),
+      m_start( m_name != nullptr ? EmbeddedTracer::now() : 0 )
+  {}
+
+  ~EmbeddedTraceScope()
+  {
+    if ( m_name != nullptr )
+      EmbeddedTracer::complete( m_name, m_start, EmbeddedTracer::now() );
+  }
+
+  EmbeddedTraceScope( const EmbeddedTraceScope& ) = delete;
+  EmbeddedTraceScope& operator=( const EmbeddedTraceScope& ) = delete;
+
+private:
+
+  const char * m_name;
+  int64_t m_start;
+};
+
+}
+
+#define TRACE_CONCAT_IMPL( a, b ) a##b
+#define TRACE_CONCAT( a, b ) TRACE_CONCAT_IMPL( a, b )
+
+#define TRACE_SCOPE( name ) sf::EmbeddedTraceScope TRACE_CONCAT( traceScope, __LINE__ ) ( name )
+#define TRACE_INSTANT( name ) \
+  do { if ( sf::EmbeddedTracer::isEnabled() ) sf::EmbeddedTracer::instant( name ); } while ( false )
+#define TRACE_THREAD_NAME( name ) sf::EmbeddedTracer::setThreadName( name )
+
+#else
+
+#define TRACE_SCOPE( name )
+#define TRACE_INSTANT( name )
+#define TRACE_THREAD_NAME( name )
+
+#endif
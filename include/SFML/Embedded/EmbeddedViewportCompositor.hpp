@@ -0,0 +1,229 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/Graphics/RenderTexture.hpp>
+#include <SFML/Graphics/View.hpp>
+#include <SFML/Window/Event.hpp>
+
+#include "SFML/Embedded/EmbeddedMemoryAccount.hpp"
+#include "SFML/Embedded/EmbeddedWindow.hpp"
+#include "SFML/Embedded/EmbeddedWindowEventReceiver.hpp"
+#include "SFML/Embedded/EmbeddedViewportReceiver.hpp"
+
+namespace sf
+{
+
+class EmbeddedViewportCompositor;
+
+////////////////////////////////////////////////////////////
+/// \brief An independent sub-view of an EmbeddedWindow
+///
+/// Each viewport covers a part of the window, has its own receiver and
+/// sf::View and is clipped to its area. Its content is kept in a render
+/// texture that is only redrawn when the viewport is invalidated.
+////////////////////////////////////////////////////////////
+class EmbeddedViewport
+{
+public:
+
+  EmbeddedViewport( const EmbeddedViewport& ) = delete;
+  EmbeddedViewport& operator=( const EmbeddedViewport& ) = delete;
+
+  /// \brief sets the part of the window covered, as a ratio of the window's size (like sf::View::setViewport)
+  ///
+  /// A created viewport is laid out again right away and receives a Resized event.
+  void setArea( const sf::FloatRect& area );
+
+  [[nodiscard]]
+  const sf::FloatRect& getArea() const { return m_area; }
+
+  /// \brief gets the part of the window covered, in window pixels
+  [[nodiscard]]
+  const sf::IntRect& getPixelArea() const { return m_pixelArea; }
+
+  /// \brief sets the view used to draw the viewport. its own viewport rect is ignored
+  void setView( const sf::View& view );
+
+  [[nodiscard]]
+  const sf::View& getView() const { return m_view; }
+
+  /// \brief sets the color the viewport is cleared with before every draw
+  void setClearColor( const sf::Color& color );
+
+  [[nodiscard]]
+  const sf::Color& getClearColor() const { return m_clearColor; }
+
+  /// \brief marks the viewport to be redrawn this frame
+  void invalidate() { m_isInvalidated = true; }
+
+  [[nodiscard]]
+  bool isInvalidated() const { return m_isInvalidated; }
+
+  /// \brief converts a point in viewport pixels (as in routed events) to the view's coordinates
+  ///
+  /// A viewport that is not created returns the point unchanged.
+  [[nodiscard]]
+  sf::Vector2f mapPixelToCoords( const sf::Vector2i& point ) const;
+
+  [[nodiscard]]
+  EmbeddedViewportReceiver& getReceiver() const { return m_receiver; }
+
+private:
+
+  friend class EmbeddedViewportCompositor;
+
+  EmbeddedViewport( EmbeddedViewportCompositor& compositor,
+                    EmbeddedViewportReceiver& receiver,
+                    const sf::FloatRect& area );
+
+  /// recomputes the pixel area and resizes the render texture
+  bool layout( const sf::Vector2u& windowSize );
+
+  /// draws the viewport into its render texture
+  void redraw();
+
+  /// releases the render texture and its charge. the viewport is no longer created
+  void release();
+
+private:
+
+  EmbeddedViewportCompositor& m_compositor;
+  EmbeddedViewportReceiver& m_receiver;
+
+  sf::FloatRect m_area;
+  sf::IntRect m_pixelArea;
+  sf::View m_view;
+  sf::Color m_clearColor { sf::Color::Black };
+
+  bool m_hasCustomView { false };
+  bool m_isInvalidated { true };
+  bool m_isCreated { false };
+  bool m_isRemoved { false };
+
+  // the viewport's content. clipping comes for free. it lives in the
+  // window's context, so it only exists while the viewport is created
+  std::unique_ptr< sf::RenderTexture > m_texture;
+
+  // the texture's bytes, charged to the window's memory account
+  EmbeddedMemoryCharge m_textureCharge;
+};
+
+////////////////////////////////////////////////////////////
+/// \brief Hosts several viewports in a single EmbeddedWindow
+///
+/// All viewports share the window's native child, GL context and timer.
+/// Events are routed to viewports by hit-testing, only the invalidated
+/// viewports are redrawn, and the window is composited and swapped once
+/// per frame, and only when something changed.
+///
+/// \code
+/// sf::EmbeddedViewportCompositor compositor;
+/// compositor.addViewport( waveform, { 0.f, 0.f, 1.f, 0.7f } );
+/// compositor.addViewport( knobs, { 0.f, 0.7f, 1.f, 0.3f } );
+///
+/// sf::BasicEmbeddedWindow< sf::EmbeddedViewportCompositor > window( parentHandle, compositor );
+/// \endcode
+////////////////////////////////////////////////////////////
+class EmbeddedViewportCompositor final : public EmbeddedWindowEventReceiver
+{
+public:
+
+  EmbeddedViewportCompositor() = default;
+  ~EmbeddedViewportCompositor();
+
+  EmbeddedViewportCompositor( const EmbeddedViewportCompositor& ) = delete;
+  EmbeddedViewportCompositor& operator=( const EmbeddedViewportCompositor& ) = delete;
+
+  ////////////////////////////////////////////////////////////
+  /// \brief adds a viewport on top of the existing ones
+  /// \param receiver draws the viewport and receives its events. must outlive the viewport
+  /// \param area part of the window covered, as a ratio of the window's size
+  /// \return the viewport, which lives until it is removed or the compositor is destroyed
+  ////////////////////////////////////////////////////////////
+  EmbeddedViewport& addViewport( EmbeddedViewportReceiver& receiver, const sf::FloatRect& area );
+
+  /// \brief removes a viewport. safe to call from the viewport's own callbacks
+  void removeViewport( EmbeddedViewport& viewport );
+
+  [[nodiscard]]
+  std::size_t getViewportCount() const { return m_viewports.size(); }
+
+  /// \brief gets the topmost viewport under a window pixel or nullptr
+  [[nodiscard]]
+  EmbeddedViewport * findViewport( const sf::Vector2i& point ) const;
+
+  /// \brief gets the viewport that receives keyboard input or nullptr
+  [[nodiscard]]
+  EmbeddedViewport * getFocusedViewport() const { return m_focused; }
+
+  /// \brief sets the color of the parts of the window no viewport covers
+  void setBackgroundColor( const sf::Color& color );
+
+  /// \brief redraws every viewport on the next frame
+  void invalidateAll();
+
+  void onWindowCreated( const EmbeddedWindow& embeddedWindow, RenderWindow& window ) override;
+
+  void onWindowDestroyed( const EmbeddedWindow& embeddedWindow, RenderWindow& window ) override;
+
+  void onError() override;
+
+  void onFrame( const EmbeddedWindow& embeddedWindow, RenderWindow& window ) override;
+
+private:
+
+  // viewports lay themselves out again when their area changes
+  friend class EmbeddedViewport;
+
+  /// sends an event to the viewport it belongs to
+  void route( const sf::Event& event );
+
+  /// sends a mouse event to a viewport in its own coordinates
+  void routeMouse( EmbeddedViewport * viewport, sf::Event event );
+
+  /// sizes every viewport after the window was resized
+  void layout( const sf::Vector2u& windowSize );
+
+  /// sizes a viewport to the current window and tells its receiver
+  void layoutViewport( EmbeddedViewport& viewport );
+
+  /// creates a viewport's render texture and notifies its receiver
+  void createViewport( EmbeddedViewport& viewport );
+
+  /// forgets a viewport everywhere it might still be referenced
+  void forget( EmbeddedViewport& viewport );
+
+  /// erases viewports removed during the frame
+  void eraseRemoved();
+
+private:
+
+  // in drawing order: the last one is on top
+  std::vector< std::unique_ptr< EmbeddedViewport > > m_viewports;
+
+  // set while the window exists
+  const EmbeddedWindow * m_embeddedWindow { nullptr };
+  sf::Vector2u m_windowSize;
+
+  // input routing
+  EmbeddedViewport * m_focused { nullptr };
+  EmbeddedViewport * m_hovered { nullptr };
+  EmbeddedViewport * m_captured { nullptr };
+  int m_capturedButtons { 0 };
+
+  sf::Color m_backgroundColor { sf::Color::Black };
+
+  // the window has to be composited even if no viewport was redrawn
+  bool m_needsComposite { true };
+
+  // removed viewports are only erased once no callback can be using them
+  bool m_isInFrame { false };
+  bool m_hasRemoved { false };
+};
+
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+namespace sf
+{
+
+class EmbeddedWindow;
+class EmbeddedViewport;
+class RenderTarget;
+class Event;
+
+class EmbeddedViewportReceiver
+{
+public:
+
+  virtual ~EmbeddedViewportReceiver() = default;
+
+  ////////////////////////////////////////////////////////////
+  /// \brief Called once the viewport can be drawn to
+  /// \param embeddedWindow the EmbeddedWindow hosting the viewport
+  /// \param viewport the viewport created
+  ////////////////////////////////////////////////////////////
+  virtual void onViewportCreated( const EmbeddedWindow& /*embeddedWindow*/, EmbeddedViewport& /*viewport*/ ) {}
+
+  ////////////////////////////////////////////////////////////
+  /// \brief Called just before the viewport is removed or the window is destroyed
+  /// \param embeddedWindow the EmbeddedWindow hosting the viewport
+  /// \param viewport the viewport to be destroyed
+  ////////////////////////////////////////////////////////////
+  virtual void onViewportDestroyed( const EmbeddedWindow& /*embeddedWindow*/, EmbeddedViewport& /*viewport*/ ) {}
+
+  ////////////////////////////////////////////////////////////
+  /// \brief Called for every event routed to this viewport
+  ///
+  ///  Mouse events go to the viewport under the cursor (or to the one that
+  ///  was pressed until the button is released), everything else goes to the
+  ///  viewport that was clicked last. Mouse positions and sizes are in the
+  ///  viewport's own pixels.
+  ///
+  /// \param viewport the viewport receiving the event
+  /// \param event the event, in viewport coordinates
+  ////////////////////////////////////////////////////////////
+  virtual void onEvent( EmbeddedViewport& /*viewport*/, const Event& /*event*/ ) {}
+
+  ////////////////////////////////////////////////////////////
+  /// \brief Called every frame after the events have been routed
+  ///
+  ///  Call viewport.invalidate() when the content has changed so that it
+  ///  gets redrawn.
+  ///
+  /// \param embeddedWindow the EmbeddedWindow hosting the viewport
+  /// \param viewport the viewport to update
+  ////////////////////////////////////////////////////////////
+  virtual void onUpdate( const EmbeddedWindow& /*embeddedWindow*/, EmbeddedViewport& /*viewport*/ ) {}
+
+  ////////////////////////////////////////////////////////////
+  /// \brief Called whenever the viewport has been invalidated
+  ///
+  ///  The target is already cleared and uses the viewport's view. Don't
+  ///  call display(), the compositor presents all viewports at once.
+  ///
+  /// \param viewport the viewport to draw
+  /// \param target where to draw the viewport's content
+  ////////////////////////////////////////////////////////////
+  virtual void onDraw( EmbeddedViewport& viewport, RenderTarget& target ) = 0;
+
+};
+
+}
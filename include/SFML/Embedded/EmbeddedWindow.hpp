@@ -1,9 +1,23 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <memory>
+#include <type_traits>
+#include <utility>
 
+#include <SFML/Graphics/RenderTexture.hpp>
 #include <SFML/Graphics/RenderWindow.hpp>
 #include "SFML/Embedded/EmbeddedWindowEventState.hpp"
+#include "SFML/Embedded/EmbeddedRenderWindow.hpp"
+#include "SFML/Embedded/EmbeddedTaskQueue.hpp"
+#include "SFML/Embedded/EmbeddedAssetLoader.hpp"
+#include "SFML/Embedded/EmbeddedFrameArena.hpp"
+#include "SFML/Embedded/EmbeddedLatencyHistogram.hpp"
+#include "SFML/Embedded/EmbeddedInputRecording.hpp"
+#include "SFML/Embedded/EmbeddedSoftwareCanvas.hpp"
+#include "SFML/Embedded/EmbeddedMemoryAccount.hpp"
+#include "SFML/Embedded/EmbeddedTracer.hpp"
 
 // forward declaration
 namespace sf::priv
@@ -17,6 +31,16 @@ namespace sf
 // forward declaration
 class EmbeddedWindowEventReceiver;
 
+////////////////////////////////////////////////////////////
+/// \brief SFML render window attached as a child of a native parent window
+///
+/// On Linux, Xlib is called from the frame thread as well as the thread
+/// that creates the window, so XInitThreads() must have run before the
+/// process opened its first X connection. The first EmbeddedWindow calls
+/// it, which is early enough unless something in the process (the plugin,
+/// SFML, a toolkit) already talked to the server. Call XInitThreads() first
+/// thing in that case. libX11 1.8 and later do it on their own.
+////////////////////////////////////////////////////////////
 class EmbeddedWindow
 {
 public:
@@ -73,26 +97,611 @@ public:
   sf::Vector2i getRelativeWindowPosition() const;
 
   /// \brief gets the cursor position relative to the embedded window
+  ///
+  /// While a recording is replayed, this is the recorded position
   [[nodiscard]]
   sf::Vector2i getCursorPosition() const;
 
+  ////////////////////////////////////////////////////////////
+  /// \brief posts a task to run on the thread that owns the render window
+  ///
+  /// Safe to call from any thread, including real-time audio threads:
+  /// it never allocates and never blocks. Queued tasks are run in bounded
+  /// batches right before onFrame, limited by the task budget.
+  ///
+  /// \param task any callable with the signature void(). it must fit in
+  ///             EmbeddedTaskQueue::TaskStorageSize bytes
+  /// \return false if the queue is full and the task was dropped
+  ////////////////////////////////////////////////////////////
+  template < typename Task >
+  bool post( Task&& task ) const
+  {
+    return m_tasks.push( std::forward< Task >( task ) );
+  }
+
+  ////////////////////////////////////////////////////////////
+  /// \brief sets how much time per frame may be spent running posted tasks
+  ///
+  /// The budget can be set and read from any thread. The other setters of
+  /// what frames do (recording, replay, latency measurement, software
+  /// fallback, memory budget, resets) can be called from the thread that
+  /// created the window. While a frame thread runs the frames (Linux,
+  /// unless host driven), they are posted to it and take effect before its
+  /// next frame.
+  ////////////////////////////////////////////////////////////
+  void setTaskBudget( sf::Time budget );
+
+  /// \brief gets how much time per frame may be spent running posted tasks. any thread
+  [[nodiscard]]
+  sf::Time getTaskBudget() const;
+
+  ////////////////////////////////////////////////////////////
+  /// \brief gets the asset loader tied to this window
+  ///
+  /// Assets are decoded in the background and uploaded right before
+  /// onFrame, so it is safe to request them in onWindowCreated.
+  ////////////////////////////////////////////////////////////
+  [[nodiscard]]
+  EmbeddedAssetLoader& getAssetLoader() const;
+
+  ////////////////////////////////////////////////////////////
+  /// \brief gets the arena for short-lived allocations made in onFrame
+  ///
+  /// The arena is reset after every onFrame, so nothing allocated from it
+  /// may be kept across frames. Render thread only.
+  ////////////////////////////////////////////////////////////
+  [[nodiscard]]
+  EmbeddedFrameArena& getFrameArena() const;
+
+  ////////////////////////////////////////////////////////////
+  /// \brief tells that this onFrame drew nothing, so the last frame stands
+  ///
+  /// Optional. An EmbeddedRemoteRenderer then neither reads the frame back
+  /// nor publishes it. Only lasts for the current onFrame. Render thread only.
+  ////////////////////////////////////////////////////////////
+  void keepLastFrame() const;
+
+  ////////////////////////////////////////////////////////////
+  /// \brief starts or stops measuring input-to-display latency
+  ///
+  /// Every native input event is timestamped when it is posted to the
+  /// window. Its latency is the time until the onFrame that polls it
+  /// returns, which is after the receiver's display(). Off by default.
+  ///
+  /// Windows and X11 (with XInput2) timestamp their input; elsewhere this
+  /// logs an error and nothing is measured.
+  ////////////////////////////////////////////////////////////
+  void setInputLatencyMeasurement( bool enabled );
+
+  /// \brief checks whether input-to-display latency is being measured
+  [[nodiscard]]
+  bool isMeasuringInputLatency() const;
+
+  /// \brief gets the input-to-display latency of every input since the last reset. render thread only
+  [[nodiscard]]
+  const EmbeddedLatencyHistogram& getInputLatency() const;
+
+  /// \brief forgets the measured input-to-display latency
+  void resetInputLatency();
+
+  ////////////////////////////////////////////////////////////
+  /// \brief posts a synthetic mouse move to the native window
+  ///
+  /// It waits in the host's message queue (the X11 connection on Linux)
+  /// like real input, so it is measured like real input. The cursor
+  /// itself is not moved.
+  ///
+  /// \return false if the native window doesn't support it
+  ////////////////////////////////////////////////////////////
+  bool injectSyntheticInput() const;
+
+  ////////////////////////////////////////////////////////////
+  /// \brief gets how long each frame took, from before the posted tasks to after onFrame
+  ///
+  /// Always recorded. Combined with EmbeddedDiagnostics it shows whether
+  /// frames get slower over a long session. Render thread only: with a
+  /// frame thread, read it from onFrame or a posted task.
+  ////////////////////////////////////////////////////////////
+  [[nodiscard]]
+  const EmbeddedLatencyHistogram& getFrameCost() const;
+
+  /// \brief forgets the recorded frame costs
+  void resetFrameCost();
+
+  ////////////////////////////////////////////////////////////
+  /// \brief gets the account that this window's memory is charged to
+  ///
+  /// Framebuffers, the asset loader's textures and decoded images, the
+  /// compositor's viewports and the frame arena are charged automatically.
+  /// Receivers can charge caches of their own with an EmbeddedMemoryCharge.
+  /// EmbeddedMemoryAccount::getProcessReport() lists every window's account.
+  ////////////////////////////////////////////////////////////
+  [[nodiscard]]
+  std::shared_ptr< EmbeddedMemoryAccount > getMemoryAccount() const;
+
+  /// \brief gets what this window holds, per kind of memory. updated before every frame
+  [[nodiscard]]
+  EmbeddedMemoryUsage getMemoryUsage() const;
+
+  ////////////////////////////////////////////////////////////
+  /// \brief sets the memory over which the receiver is asked to shed caches
+  ///
+  /// The receiver's onMemoryBudgetExceeded is called before the frame that
+  /// finds the usage over budget, and the asset loader holds back its
+  /// uploads for that frame.
+  ///
+  /// \param bytes GPU and CPU memory together. 0 (the default) is no budget
+  ////////////////////////////////////////////////////////////
+  void setMemoryBudget( uint64_t bytes );
+
+  [[nodiscard]]
+  uint64_t getMemoryBudget() const;
+
+  ////////////////////////////////////////////////////////////
+  /// \brief starts recording the input of this window
+  ///
+  /// Every native input message is added to the recording as it arrives,
+  /// and every frame adds the cursor position and the window size. Stops
+  /// any replay.
+  ///
+  /// \param recording cleared first. it must outlive the recording
+  /// \return false without a native window or where native input can't be
+  /// recorded (X11 without XInput2)
+  ////////////////////////////////////////////////////////////
+  bool startRecording( EmbeddedInputRecording& recording );
+
+  /// \brief stops recording input
+  void stopRecording();
+
+  /// \brief checks whether input is being recorded
+  [[nodiscard]]
+  bool isRecording() const;
+
+  ////////////////////////////////////////////////////////////
+  /// \brief starts feeding a recording back into this window
+  ///
+  /// The recorded messages go through the native window again, so the
+  /// receiver polls the same events as in the recorded session. Real input
+  /// keeps arriving too; replay into a window nobody touches. Modifier keys
+  /// are read from the live keyboard by SFML and are not replayed.
+  ///
+  /// With E_ReplayAsFastAsPossible, every frame replays one recorded frame;
+  /// drive them with runFrame() to go faster than the native timer.
+  ///
+  /// \param recording it must outlive the replay
+  /// \param mode pace of the replay
+  /// \return false without a native window, with an empty recording or
+  /// where native input can't be replayed
+  ////////////////////////////////////////////////////////////
+  bool startReplay( const EmbeddedInputRecording& recording, E_EmbeddedReplayMode mode );
+
+  /// \brief stops replaying a recording
+  void stopReplay();
+
+  /// \brief checks whether a recording is being replayed. false once it has been replayed entirely
+  [[nodiscard]]
+  bool isReplaying() const;
+
+  ////////////////////////////////////////////////////////////
+  /// \brief sets when frames are rendered in software rather than with OpenGL
+  ///
+  /// In software, the receiver's onSoftwareFrame is called instead of
+  /// onFrame and draws into an EmbeddedSoftwareCanvas, which the native
+  /// window presents without a GPU. Receivers that can't render in software
+  /// keep using OpenGL; without an OpenGL context they get onError.
+  ///
+  /// The default is E_SoftwareFallbackOnFailure. Once E_SoftwareFallbackWhenSlow
+  /// has switched to software, it stays there.
+  ////////////////////////////////////////////////////////////
+  void setSoftwareFallback( E_EmbeddedSoftwareFallback fallback );
+
+  [[nodiscard]]
+  E_EmbeddedSoftwareFallback getSoftwareFallback() const;
+
+  /// \brief sets the frame cost over which OpenGL counts as too slow (default is 60 Hz)
+  void setSoftwareFallbackBudget( sf::Time budget );
+
+  /// \brief checks whether frames are rendered in software
+  [[nodiscard]]
+  bool isRenderingInSoftware() const;
+
+  ////////////////////////////////////////////////////////////
+  /// \brief runs a frame right away, outside of the native timer
+  ///
+  /// Meant for benchmark drivers, e.g.
+  /// while ( window.isReplaying() ) window.runFrame();
+  ///
+  /// A frame thread owns the GL context while it runs; call
+  /// setHostDriven( true ) first to run frames from another thread.
+  ///
+  /// \return false without a render window, when called from a frame or
+  /// while a frame thread runs the frames
+  ////////////////////////////////////////////////////////////
+  bool runFrame();
+
+  ////////////////////////////////////////////////////////////
+  /// \brief lets the host's event loop drive the frames, rather than a native timer or frame thread
+  ///
+  /// For hosts that run plugins on their own loop (CLAP's posix-fd-support
+  /// and timer-support, VST3's IRunLoop). While host driven, frames only run
+  /// from processPending(). Register getPollDescriptor() with the host for
+  /// reading, and a timer at getPollRateInMS() for when there is no
+  /// descriptor or the display has no vblank notifications.
+  ///
+  /// Call it from the thread that will call processPending(). The GL
+  /// context moves to that thread. A frame thread can't stop itself, so it
+  /// can't be called from onFrame while one runs.
+  ///
+  /// \return false if the native window can't be driven by the host
+  ////////////////////////////////////////////////////////////
+  bool setHostDriven( bool isHostDriven );
+
+  [[nodiscard]]
+  bool isHostDriven() const;
+
+  /// \brief gets a file descriptor that becomes readable when processPending() has work
+  /// \return -1 where there is none. on Windows the host's message loop already delivers native events
+  [[nodiscard]]
+  int getPollDescriptor() const;
+
+  ////////////////////////////////////////////////////////////
+  /// \brief handles pending native events and runs a frame if one is due
+  ///
+  /// Called by the host when the descriptor is readable or its timer fires.
+  ///
+  /// \return true if a frame was run
+  ////////////////////////////////////////////////////////////
+  bool processPending();
+
 protected:
 
-  /// \brief Construct the child window and attach it to a parent control
+  /// native window notifications are forwarded through a plain function pointer
+  using ObserverCallback = void ( * )( void * context, E_EmbeddedWindowEventState state );
+
+  /// \brief Constructs an EmbeddedWindow without a native window. derived classes call create()
+  EmbeddedWindow() = default;
+
+  ////////////////////////////////////////////////////////////
+  /// \brief Creates the native child window and the render window
+  ///
+  /// \param parentHandle Native handle of the parent window
+  /// \param contextSettings SFML context settings
+  /// \param startingSize starting window size (0 uses the parent's window size)
+  /// \param callback receives every native window notification
+  /// \param context passed back to the callback
+  ////////////////////////////////////////////////////////////
+  void create( WindowHandle parentHandle,
+               const sf::ContextSettings& contextSettings,
+               const sf::Vector2u& startingSize,
+               ObserverCallback callback,
+               void * context );
+
+  ////////////////////////////////////////////////////////////
+  /// \brief Creates the render window on top of an existing native window
+  ///
+  /// \param impl native window, created with an observer that forwards to
+  ///             callback and context. EmbeddedWindow takes ownership
+  /// \param contextSettings SFML context settings
+  /// \param startingSize starting window size (0 uses the parent's window size)
+  /// \param callback receives every native window notification
+  /// \param context passed back to the callback
+  ////////////////////////////////////////////////////////////
+  void attach( priv::EmbeddedWindowImpl * impl,
+               const sf::ContextSettings& contextSettings,
+               const sf::Vector2u& startingSize,
+               ObserverCallback callback,
+               void * context );
+
+  ////////////////////////////////////////////////////////////
+  /// \brief Destroys the native child window. Safe to call more than once.
+  ///
+  /// Derived classes that dispatch to their own receiver must call this in
+  /// their destructor, while that receiver can still be reached.
+  ////////////////////////////////////////////////////////////
+  void destroy();
+
+  ////////////////////////////////////////////////////////////
+  /// \brief Renders every frame into a render texture instead of the window
+  ///
+  /// For windows that are never shown, whose default framebuffer can't be
+  /// read back reliably. Call it before create() or attach().
+  ////////////////////////////////////////////////////////////
+  void setRenderingOffscreen();
+
+  ////////////////////////////////////////////////////////////
+  /// \brief Binds the offscreen frame for reading, e.g. with glReadPixels
   ///
-  /// \param state Platform-specific handle of the parent control
+  /// \return false if the last frame didn't go to the offscreen frame
+  /// (software frames, no OpenGL context or not rendering offscreen) or
+  /// the receiver kept the frame before it (see keepLastFrame)
+  ////////////////////////////////////////////////////////////
+  bool bindOffscreenFrame();
+
+  /// \brief Dispatches a native window notification to the event receiver
+  ///
+  /// \param state the state of the native window
   virtual void onObservation( E_EmbeddedWindowEventState state );
 
+  ////////////////////////////////////////////////////////////
+  /// \brief Dispatches a native window notification to any receiver
+  ///
+  /// Receiver only needs the same member functions as
+  /// EmbeddedWindowEventReceiver. When its type is known (or final), the
+  /// calls are resolved at compile time and can be inlined.
+  ////////////////////////////////////////////////////////////
+  template < typename Receiver >
+  void dispatch( Receiver& receiver, E_EmbeddedWindowEventState state );
+
+private:
+
+  /// runs the per-frame work that happens before onFrame
+  void beginFrame();
+
+  /// runs the per-frame work that happens after onFrame
+  void endFrame();
+
+  /// feeds the input of the recorded frames that are due into the native window
+  void replayFrame();
+
+  /// checks whether frames run on a frame thread of the native window
+  [[nodiscard]]
+  bool hasFrameThread() const;
+
+  /// changes what frames do, on the thread that runs them. posted when that is a frame thread
+  template < typename Change >
+  bool applyToFrames( Change&& change );
+
+  /// switches between OpenGL and software, as the fallback asks for
+  void updateRenderMode();
+
+  /// gets a canvas over the native window's framebuffer. null if there is none
+  EmbeddedSoftwareCanvas * beginSoftwareFrame();
+
+  /// presents the canvas, or goes back to OpenGL if the receiver didn't draw it
+  void endSoftwareFrame( bool isDrawn );
+
+  /// runs a frame in software
+  template < typename Receiver >
+  void renderSoftwareFrame( Receiver& receiver );
+
+  /// creates the render texture frames are drawn into, at the window's size
+  bool createOffscreenFrame();
+
+  /// releases the offscreen frame. the GL context has to be active
+  void releaseOffscreenFrame();
+
+  /// recomputes the charges of the window's own buffers and checks the budget
+  void updateMemoryUsage();
+
+  /// asks the receiver to shed caches
+  template < typename Receiver >
+  void notifyMemoryBudgetExceeded( Receiver& receiver );
+
+  /// forwards native window notifications to the virtual onObservation
+  static void observeVirtual( void * context, E_EmbeddedWindowEventState state );
+
 private:
 
-  // the event callback associated with this window
-  EmbeddedWindowEventReceiver& m_embeddedWindowEvent;
+  // the event callback associated with this window (null when the
+  // receiver is bound statically, see BasicEmbeddedWindow)
+  EmbeddedWindowEventReceiver * m_embeddedWindowEvent { nullptr };
+
+  // set once the render window exists and onWindowCreated can be called
+  bool m_isCreated { false };
 
   // platform-specific implementation of child window
   priv::EmbeddedWindowImpl * m_impl { nullptr };
 
   // the SFML render window as a child window
-  sf::RenderWindow m_window;
+  priv::EmbeddedRenderWindow m_window;
+
+  // tasks posted from other threads, run on the render thread before each frame
+  mutable EmbeddedTaskQueue m_tasks { 256 };
+
+  // maximum time spent running posted tasks per frame. read by the frame
+  // thread, set from any thread
+  std::atomic< int64_t > m_taskBudgetInUS { 2000 };
+
+  // scratch memory for onFrame. reset after every frame
+  mutable EmbeddedFrameArena m_frameArena { 64 * 1024 };
+
+  // input-to-display latency, when it is being measured
+  EmbeddedLatencyHistogram m_inputLatency;
+
+  // duration of every frame. everything below is only touched by the
+  // thread that runs the frames, unless it's atomic
+  std::chrono::steady_clock::time_point m_frameStart;
+  EmbeddedLatencyHistogram m_frameCost;
+  bool m_isInFrame { false };
+
+  // set by the receiver when onFrame drew nothing
+  mutable bool m_isLastFrameKept { false };
+
+  // the notifications go here, so that runFrame can start a frame
+  ObserverCallback m_callback { nullptr };
+  void * m_context { nullptr };
+
+  // frames run from processPending rather than on their own. only changed
+  // while no frame thread runs
+  bool m_isHostDriven { false };
+
+  // input being recorded
+  std::atomic< EmbeddedInputRecording * > m_recording { nullptr };
+  std::chrono::steady_clock::time_point m_recordingStart;
+
+  // software rendering
+  bool m_hasGlContext { false };
+  std::atomic< bool > m_isRenderingInSoftware { false };
+  bool m_isSoftwareUnsupported { false };
+  std::atomic< E_EmbeddedSoftwareFallback > m_softwareFallback { E_SoftwareFallbackOnFailure };
+  EmbeddedSoftwareCanvas m_softwareCanvas;
+  sf::Vector2u m_softwareSize;
+
+  // frames drawn into a render texture rather than the window
+  bool m_isOffscreen { false };
+  std::unique_ptr< sf::RenderTexture > m_offscreenFrame;
+
+  // OpenGL frames over the budget, out of the last few
+  sf::Time m_softwareFallbackBudget { sf::microseconds( 16667 ) };
+  uint32_t m_glFrames { 0 };
+  uint32_t m_slowGlFrames { 0 };
+  static constexpr uint32_t SlowFrameWindow = 60;
+
+  // input being replayed. m_replayFrame is the next recorded frame to replay
+  std::atomic< const EmbeddedInputRecording * > m_replay { nullptr };
+  E_EmbeddedReplayMode m_replayMode { E_ReplayRealTime };
+  std::size_t m_replayFrame { 0 };
+  std::chrono::steady_clock::time_point m_replayStart;
+  sf::Vector2i m_replayCursor;
+
+  // memory charged to this window. the charges are declared after the account
+  std::shared_ptr< EmbeddedMemoryAccount > m_memoryAccount { std::make_shared< EmbeddedMemoryAccount >() };
+  EmbeddedMemoryCharge m_framebufferCharge { m_memoryAccount, E_MemoryFramebuffer };
+  EmbeddedMemoryCharge m_softwareFramebufferCharge { m_memoryAccount, E_MemorySoftwareFramebuffer };
+  EmbeddedMemoryCharge m_heapCharge { m_memoryAccount, E_MemoryHeap };
+  EmbeddedMemoryCharge m_offscreenFrameCharge { m_memoryAccount, E_MemoryRenderTextures };
+  bool m_isOverMemoryBudget { false };
+  bool m_isMemoryBudgetNoticeDue { false };
+
+  // numbers the windows in memory reports
+  inline static std::atomic< uint32_t > smWindowCount { 0 };
+
+  // background loading of textures and fonts. the loader's textures are
+  // released (see EmbeddedAssetLoader::release) before the window closes
+  mutable EmbeddedAssetLoader m_assets;
 };
 
-}
\ No newline at end of file
+////////////////////////////////////////////////////////////
+template < typename Receiver >
+void EmbeddedWindow::dispatch( Receiver& receiver, E_EmbeddedWindowEventState state )
+{
+  switch ( state )
+  {
+    case E_WindowCreated:
+      // the native window reports this before the render window exists,
+      // which is ignored. create() reports it again once everything is set up
+      if ( m_isCreated )
+      {
+        TRACE_SCOPE( "onWindowCreated" );
+        receiver.onWindowCreated( *this, m_window );
+      }
+      break;
+
+    case E_FrameReady:
+    {
+      TRACE_SCOPE( "frame" );
+      beginFrame();
+
+      if ( m_isMemoryBudgetNoticeDue )
+      {
+        TRACE_SCOPE( "onMemoryBudgetExceeded" );
+        notifyMemoryBudgetExceeded( receiver );
+      }
+
+      if ( m_isRenderingInSoftware.load( std::memory_order_relaxed ) )
+      {
+        TRACE_SCOPE( "onSoftwareFrame" );
+        renderSoftwareFrame( receiver );
+      }
+      else
+      {
+        TRACE_SCOPE( "onFrame" );
+        receiver.onFrame( *this, m_window );
+      }
+
+      endFrame();
+      break;
+    }
+
+    case E_WindowDestroyed:
+    {
+      // a frame thread handed the context back as it stopped
+      if ( m_hasGlContext )
+        m_window.setActive( true );
+
+      TRACE_SCOPE( "onWindowDestroyed" );
+      receiver.onWindowDestroyed( *this, m_window );
+
+      // the context is still active here, which deleting textures needs
+      m_assets.release();
+      releaseOffscreenFrame();
+
+      // let go of the native window (and the GL context with it) before the
+      // native window is destroyed
+      m_window.close();
+      break;
+    }
+
+    case E_FramesStopped:
+      // a frame thread that exits must not keep the GL context with it
+      m_window.setActive( false );
+      break;
+
+    default:
+      TRACE_INSTANT( "onError" );
+      receiver.onError();
+      break;
+  }
+}
+
+namespace priv
+{
+
+////////////////////////////////////////////////////////////
+/// \brief Checks whether a receiver can render in software
+////////////////////////////////////////////////////////////
+template < typename Receiver, typename = void >
+struct HasSoftwareFrame : std::false_type {};
+
+template < typename Receiver >
+struct HasSoftwareFrame< Receiver,
+                         std::void_t< decltype( std::declval< Receiver& >().onSoftwareFrame(
+                           std::declval< const EmbeddedWindow& >(),
+                           std::declval< RenderWindow& >(),
+                           std::declval< EmbeddedSoftwareCanvas& >() ) ) > > : std::true_type {};
+
+////////////////////////////////////////////////////////////
+/// \brief Checks whether a receiver can shed caches when memory goes over budget
+////////////////////////////////////////////////////////////
+template < typename Receiver, typename = void >
+struct HasMemoryBudgetExceeded : std::false_type {};
+
+template < typename Receiver >
+struct HasMemoryBudgetExceeded< Receiver,
+                                std::void_t< decltype( std::declval< Receiver& >().onMemoryBudgetExceeded(
+                                  std::declval< const EmbeddedWindow& >(),
+                                  std::declval< const EmbeddedMemoryUsage& >() ) ) > > : std::true_type {};
+
+}
+
+////////////////////////////////////////////////////////////
+template < typename Receiver >
+void EmbeddedWindow::renderSoftwareFrame( Receiver& receiver )
+{
+  bool isDrawn = false;
+
+  // statically bound receivers don't have to implement it at all
+  if constexpr ( priv::HasSoftwareFrame< Receiver >::value )
+  {
+    if ( auto * canvas = beginSoftwareFrame() )
+      isDrawn = receiver.onSoftwareFrame( *this, m_window, *canvas );
+  }
+
+  endSoftwareFrame( isDrawn );
+
+  // neither way works
+  if ( !isDrawn && !m_hasGlContext )
+    receiver.onError();
+}
+
+////////////////////////////////////////////////////////////
+template < typename Receiver >
+void EmbeddedWindow::notifyMemoryBudgetExceeded( Receiver& receiver )
+{
+  m_isMemoryBudgetNoticeDue = false;
+
+  if constexpr ( priv::HasMemoryBudgetExceeded< Receiver >::value )
+    receiver.onMemoryBudgetExceeded( *this, m_memoryAccount->getUsage() );
+}
+
+}
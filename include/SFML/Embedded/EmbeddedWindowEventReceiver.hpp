@@ -4,6 +4,8 @@ namespace sf
 {
 
 class RenderWindow;
+class EmbeddedSoftwareCanvas;
+struct EmbeddedMemoryUsage;
 
 class EmbeddedWindowEventReceiver
 {
@@ -11,6 +13,9 @@ public:
 
   ////////////////////////////////////////////////////////////
   /// \brief Called whenever a render window is first created (just before the message pump)
+  ///
+  ///  Called on the thread that creates the EmbeddedWindow, before any frame runs.
+  ///
   /// \param embeddedWindow the EmbeddedWindow that manages sf::RenderWindow lifetime
   /// \param window the sf::RenderWindow created
   ////////////////////////////////////////////////////////////
@@ -18,6 +23,9 @@ public:
 
   ////////////////////////////////////////////////////////////
   /// \brief Called during the destruction of sf::RenderWindow (just before)
+  ///
+  ///  Called on the thread that destroys the EmbeddedWindow, once no frame runs anymore.
+  ///
   /// \param embeddedWindow the EmbeddedWindow that manages sf::RenderWindow lifetime
   /// \param window the sf::RenderWindow to be destroyed
   ////////////////////////////////////////////////////////////
@@ -33,13 +41,54 @@ public:
   ///
   ///  The entire event loop should be processed, i.e.,
   ///  polling until all events are cleared and rendering.
-  ///  This gets called on the same thread that sf::RenderWindow was created
+  ///
+  ///  Called on the thread that runs the frames, which holds the GL context.
+  ///  That is the thread that created the sf::RenderWindow, except on Linux,
+  ///  where a frame thread of the library calls it. After
+  ///  EmbeddedWindow::setHostDriven( true ), it is the thread that calls
+  ///  processPending. onSoftwareFrame, onMemoryBudgetExceeded and posted
+  ///  tasks run on the same thread.
   ///
   /// \param embeddedWindow the EmbeddedWindow that manages sf::RenderWindow lifetime
   /// \param window the sf::RenderWindow
   ////////////////////////////////////////////////////////////
   virtual void onFrame( const EmbeddedWindow& embeddedWindow, RenderWindow& window ) = 0;
 
+  ////////////////////////////////////////////////////////////
+  /// \brief Called instead of onFrame while the window renders in software
+  ///
+  ///  Events are still polled from window, but nothing may be drawn to it.
+  ///  Draw into canvas instead, which is presented once this returns.
+  ///  See EmbeddedWindow::setSoftwareFallback
+  ///
+  /// \param embeddedWindow the EmbeddedWindow that manages sf::RenderWindow lifetime
+  /// \param window the sf::RenderWindow, for its events
+  /// \param canvas the framebuffer of this frame
+  /// \return false if the receiver can't render in software (the default)
+  ////////////////////////////////////////////////////////////
+  virtual bool onSoftwareFrame( const EmbeddedWindow& /*embeddedWindow*/,
+                                RenderWindow& /*window*/,
+                                EmbeddedSoftwareCanvas& /*canvas*/ )
+  {
+    return false;
+  }
+
+  ////////////////////////////////////////////////////////////
+  /// \brief Called before a frame once the window's memory goes over its budget
+  ///
+  ///  Release caches (textures, render textures, decoded images) here,
+  ///  before allocations start to fail. Called again only after the usage
+  ///  went back under the budget and crossed it once more.
+  ///  See EmbeddedWindow::setMemoryBudget
+  ///
+  /// \param embeddedWindow the EmbeddedWindow that manages sf::RenderWindow lifetime
+  /// \param usage what the window holds, per kind of memory
+  ////////////////////////////////////////////////////////////
+  virtual void onMemoryBudgetExceeded( const EmbeddedWindow& /*embeddedWindow*/,
+                                       const EmbeddedMemoryUsage& /*usage*/ )
+  {
+  }
+
 };
 
 }
\ No newline at end of file
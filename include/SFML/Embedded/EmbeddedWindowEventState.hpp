@@ -5,5 +5,6 @@ enum E_EmbeddedWindowEventState
   E_WindowCreated,
   E_FrameReady,
   E_WindowDestroyed,
+  E_FramesStopped, // the thread that ran the frames won't run any more
   E_Error
 };
\ No newline at end of file
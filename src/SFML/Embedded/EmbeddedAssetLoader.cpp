@@ -0,0 +1,435 @@
+#include "SFML/Embedded/EmbeddedAssetLoader.hpp"
+#include "SFML/Embedded/EmbeddedLogger.hpp"
+#include "SFML/Embedded/EmbeddedTracer.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <utility>
+
+#include <SFML/System/Clock.hpp>
+
+namespace sf
+{
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+const sf::Texture& EmbeddedTextureAsset::getTexture() const
+{
+  if ( isReady() )
+    return m_texture;
+
+  // first use of the placeholder. it can only be created on the render thread
+  if ( m_placeholder->getSize().x == 0 )
+  {
+    const uint8_t transparentPixel[ 4 ] { 0, 0, 0, 0 };
+    if ( m_placeholder->create( 1, 1 ) )
+      m_placeholder->update( transparentPixel );
+  }
+
+  return *m_placeholder;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+sf::Vector2u EmbeddedTextureAsset::getSize() const
+{
+  return { m_width.load( std::memory_order_relaxed ), m_height.load( std::memory_order_relaxed ) };
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+const sf::Font& EmbeddedFontAsset::getFont() const
+{
+  return isReady() ? m_font : smEmptyFont;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+EmbeddedAssetLoader::EmbeddedAssetLoader()
+  : m_placeholder( std::make_shared< sf::Texture >() )
+{}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+EmbeddedAssetLoader::~EmbeddedAssetLoader()
+{
+  stopWorkers();
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+std::shared_ptr< EmbeddedTextureAsset > EmbeddedAssetLoader::loadTexture( const std::string& filename,
+                                                                          bool smooth )
+{
+  auto asset = std::make_shared< EmbeddedTextureAsset >();
+  asset->m_smooth = smooth;
+  asset->m_placeholder = m_placeholder;
+
+  enqueueJob( asset->m_state, [ this, asset, filename ]
+  {
+    sf::Image image;
+    if ( image.loadFromFile( filename ) )
+      submitImage( asset, std::move( image ) );
+    else
+    {
+      LOG_ERROR( "failed to decode texture {}", filename );
+      fail( asset );
+    }
+  } );
+
+  return asset;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+std::shared_ptr< EmbeddedTextureAsset > EmbeddedAssetLoader::loadTextureFromMemory( const void * data,
+                                                                                    std::size_t size,
+                                                                                    bool smooth )
+{
+  auto asset = std::make_shared< EmbeddedTextureAsset >();
+  asset->m_smooth = smooth;
+  asset->m_placeholder = m_placeholder;
+
+  enqueueJob( asset->m_state, [ this, asset, data, size ]
+  {
+    sf::Image image;
+    if ( image.loadFromMemory( data, size ) )
+      submitImage( asset, std::move( image ) );
+    else
+    {
+      LOG_ERROR( "failed to decode texture from memory" );
+      fail( asset );
+    }
+  } );
+
+  return asset;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+std::shared_ptr< EmbeddedFontAsset > EmbeddedAssetLoader::loadFont( const std::string& filename )
+{
+  auto asset = std::make_shared< EmbeddedFontAsset >();
+
+  enqueueJob( asset->m_state, [ this, asset, filename ]
+  {
+    // read the whole file up front so that sf::Font never touches the disk
+    // from the render thread later on
+    std::ifstream file( filename, std::ios::binary | std::ios::ate );
+    if ( file )
+    {
+      asset->m_fileData.resize( static_cast< std::size_t >( file.tellg() ) );
+      file.seekg( 0 );
+      file.read( asset->m_fileData.data(), static_cast< std::streamsize >( asset->m_fileData.size() ) );
+    }
+
+    asset->m_fileDataCharge = EmbeddedMemoryCharge( m_memoryAccount, E_MemoryHeap );
+    asset->m_fileDataCharge.setBytes( asset->m_fileData.size() );
+
+    // sf::Font only creates its glyph textures on demand, so opening it here is safe
+    if ( file && asset->m_font.loadFromMemory( asset->m_fileData.data(), asset->m_fileData.size() ) )
+    {
+      std::unique_lock< std::mutex > lock( m_uploadMutex );
+      m_fonts.push_back( { asset } );
+    }
+    else
+    {
+      LOG_ERROR( "failed to load font {}", filename );
+
+      // a failed handle can be kept around for a long time. don't let it hold on to the file
+      asset->m_fileData = {};
+      asset->m_fileDataCharge.setBytes( 0 );
+      asset->m_state.store( E_AssetFailed, std::memory_order_release );
+      --m_pendingCount;
+    }
+  } );
+
+  return asset;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedAssetLoader::setWorkerCount( uint32_t count )
+{
+  std::unique_lock< std::mutex > lock( m_jobMutex );
+
+  if ( !m_workers.empty() )
+    LOG_WARN( "asset workers have already started. ignoring new worker count." );
+  else
+    m_workerCount = std::max( count, 1u );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedAssetLoader::setMemoryAccount( std::shared_ptr< EmbeddedMemoryAccount > account )
+{
+  m_memoryAccount = std::move( account );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedAssetLoader::setUploadBudget( sf::Time budget )
+{
+  m_uploadBudgetInUS.store( budget.asMicroseconds(), std::memory_order_relaxed );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedAssetLoader::processUploads()
+{
+  if ( m_pendingCount.load( std::memory_order_relaxed ) == 0 )
+    return;
+
+  sf::Clock clock;
+  const auto budget = getUploadBudget();
+
+  {
+    std::unique_lock< std::mutex > lock( m_uploadMutex );
+
+    // fonts are already usable. flip them here so that they only ever change between frames
+    for ( auto& pending : m_fonts )
+    {
+      pending.asset->m_state.store( E_AssetReady, std::memory_order_release );
+      --m_pendingCount;
+    }
+
+    m_fonts.clear();
+  }
+
+  while ( clock.getElapsedTime() < budget )
+  {
+    if ( !m_currentUpload )
+    {
+      std::unique_lock< std::mutex > lock( m_uploadMutex );
+      if ( m_uploads.empty() )
+        break;
+
+      m_currentUpload = std::make_unique< PendingUpload >( std::move( m_uploads.front() ) );
+      m_uploads.pop_front();
+    }
+
+    if ( uploadSlice( *m_currentUpload, budget - clock.getElapsedTime() ) )
+      m_currentUpload.reset();
+  }
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedAssetLoader::release()
+{
+  // nothing can be handed over anymore once the workers are gone. loads
+  // that never reached a worker fail there
+  stopWorkers();
+
+  std::deque< PendingUpload > uploads;
+  std::deque< PendingFont > fonts;
+
+  {
+    std::unique_lock< std::mutex > lock( m_uploadMutex );
+    uploads.swap( m_uploads );
+    fonts.swap( m_fonts );
+  }
+
+  if ( m_currentUpload )
+  {
+    uploads.push_back( std::move( *m_currentUpload ) );
+    m_currentUpload.reset();
+  }
+
+  for ( auto& upload : uploads )
+  {
+    // the texture may already have been created for the first slices
+    upload.asset->m_texture = sf::Texture();
+    upload.asset->m_textureCharge.setBytes( 0 );
+    fail( upload.asset );
+  }
+
+  for ( auto& pending : fonts )
+  {
+    pending.asset->m_state.store( E_AssetFailed, std::memory_order_release );
+    --m_pendingCount;
+  }
+
+  // handles still in use recreate the placeholder lazily
+  *m_placeholder = sf::Texture();
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+void EmbeddedAssetLoader::enqueueJob( std::atomic< E_EmbeddedAssetState >& state, std::function< void() > decode )
+{
+  ++m_pendingCount;
+
+  {
+    std::unique_lock< std::mutex > lock( m_jobMutex );
+    ensureWorkersStarted();
+    m_jobs.push_back( { std::move( decode ), &state } );
+  }
+
+  m_jobCondition.notify_one();
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+void EmbeddedAssetLoader::ensureWorkersStarted()
+{
+  // workers are only started once something is loaded, so windows that
+  // never load anything never pay for the threads
+  if ( !m_workers.empty() )
+    return;
+
+  for ( uint32_t i = 0; i < m_workerCount; ++i )
+    m_workers.emplace_back( [ this ] { runWorker(); } );
+
+  LOG_DEBUG( "started {} asset workers", m_workerCount );
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+void EmbeddedAssetLoader::stopWorkers()
+{
+  std::deque< PendingJob > jobs;
+
+  {
+    std::unique_lock< std::mutex > lock( m_jobMutex );
+    m_stopping = true;
+    jobs.swap( m_jobs );
+  }
+
+  m_jobCondition.notify_all();
+
+  // jobs that no worker picked up are abandoned
+  for ( auto& job : jobs )
+  {
+    job.state->store( E_AssetFailed, std::memory_order_release );
+    --m_pendingCount;
+  }
+
+  jobs.clear();
+
+  for ( auto& worker : m_workers )
+    worker.join();
+
+  // workers start again with the next load
+  std::unique_lock< std::mutex > lock( m_jobMutex );
+  m_workers.clear();
+  m_stopping = false;
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+void EmbeddedAssetLoader::runWorker()
+{
+  TRACE_THREAD_NAME( "sfml-embedded asset worker" );
+
+  for ( ;; )
+  {
+    PendingJob job;
+
+    {
+      std::unique_lock< std::mutex > lock( m_jobMutex );
+      m_jobCondition.wait( lock, [ this ] { return m_stopping || !m_jobs.empty(); } );
+
+      if ( m_stopping )
+        return;
+
+      job = std::move( m_jobs.front() );
+      m_jobs.pop_front();
+    }
+
+    TRACE_SCOPE( "asset decode" );
+    job.decode();
+  }
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+void EmbeddedAssetLoader::submitImage( const std::shared_ptr< EmbeddedTextureAsset >& asset, sf::Image&& image )
+{
+  const auto size = image.getSize();
+
+  if ( size.x == 0 || size.y == 0 )
+  {
+    LOG_ERROR( "decoded texture is empty" );
+    fail( asset );
+    return;
+  }
+
+  asset->m_width.store( size.x, std::memory_order_relaxed );
+  asset->m_height.store( size.y, std::memory_order_relaxed );
+
+  EmbeddedMemoryCharge imageCharge( m_memoryAccount, E_MemoryHeap );
+  imageCharge.setBytes( static_cast< uint64_t >( size.x ) * size.y * 4 );
+
+  std::unique_lock< std::mutex > lock( m_uploadMutex );
+  m_uploads.push_back( { asset, std::move( image ), 0, false, std::move( imageCharge ) } );
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+void EmbeddedAssetLoader::fail( const std::shared_ptr< EmbeddedTextureAsset >& asset )
+{
+  asset->m_state.store( E_AssetFailed, std::memory_order_release );
+  --m_pendingCount;
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+bool EmbeddedAssetLoader::uploadSlice( PendingUpload& upload, sf::Time timeLeft )
+{
+  auto& asset = *upload.asset;
+  const auto size = upload.image.getSize();
+
+  // allocating the storage can be expensive, so the budget is checked again before the first rows
+  if ( !upload.created )
+  {
+    // querying the limit needs a GL context, which is why it isn't checked by the workers
+    const auto maxSize = sf::Texture::getMaximumSize();
+    if ( size.x > maxSize || size.y > maxSize )
+    {
+      LOG_ERROR( "texture size {}x{} is not supported (max is {})", size.x, size.y, maxSize );
+      fail( upload.asset );
+      return true;
+    }
+
+    if ( !asset.m_texture.create( size.x, size.y ) )
+    {
+      LOG_ERROR( "failed to create texture of size {}x{}", size.x, size.y );
+      fail( upload.asset );
+      return true;
+    }
+
+    asset.m_texture.setSmooth( asset.m_smooth );
+    asset.m_textureCharge = EmbeddedMemoryCharge( m_memoryAccount, E_MemoryTextures );
+    asset.m_textureCharge.setBytes( static_cast< uint64_t >( size.x ) * size.y * 4 );
+    upload.created = true;
+    return false;
+  }
+
+  sf::Clock clock;
+
+  const std::size_t rowSizeInBytes = static_cast< std::size_t >( size.x ) * 4;
+  const auto rowsPerSlice = static_cast< uint32_t >( std::max< std::size_t >( 1, SliceSizeInBytes / rowSizeInBytes ) );
+
+  while ( upload.nextRow < size.y && clock.getElapsedTime() < timeLeft )
+  {
+    const auto rows = std::min( rowsPerSlice, size.y - upload.nextRow );
+
+    asset.m_texture.update( upload.image.getPixelsPtr() + upload.nextRow * rowSizeInBytes,
+                            size.x,
+                            rows,
+                            0,
+                            upload.nextRow );
+
+    upload.nextRow += rows;
+  }
+
+  if ( upload.nextRow < size.y )
+    return false;
+
+  asset.m_state.store( E_AssetReady, std::memory_order_release );
+  --m_pendingCount;
+  return true;
+}
+
+}
@@ -0,0 +1,116 @@
+#include "SFML/Embedded/EmbeddedFrameArena.hpp"
+#include "SFML/Embedded/EmbeddedLogger.hpp"
+
+#include <algorithm>
+#include <tuple>
+
+namespace sf
+{
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+EmbeddedFrameArena::EmbeddedFrameArena( std::size_t initialCapacity, std::pmr::memory_resource * upstream )
+  : m_upstream( upstream ),
+    m_buffer( static_cast< std::byte * >( upstream->allocate( initialCapacity, BufferAlignment ) ) ),
+    m_capacity( initialCapacity )
+{}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+EmbeddedFrameArena::~EmbeddedFrameArena()
+{
+  releaseOverflow();
+  m_upstream->deallocate( m_buffer, m_capacity, BufferAlignment );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedFrameArena::reset()
+{
+  const auto used = getUsedBytes();
+  if ( used > m_highWaterMark )
+    m_highWaterMark = used;
+
+  if ( m_overflow != nullptr )
+  {
+    releaseOverflow();
+
+    // grow once so that the next frame of the same size fits in the buffer.
+    // alignment padding is why this gets a little extra room
+    auto capacity = std::max< std::size_t >( m_capacity, 1024 );
+    while ( capacity < m_highWaterMark + m_highWaterMark / 8 )
+      capacity *= 2;
+
+    LOG_DEBUG( "frame arena overflowed. growing from {} to {} bytes", m_capacity, capacity );
+
+    m_upstream->deallocate( m_buffer, m_capacity, BufferAlignment );
+    m_buffer = static_cast< std::byte * >( m_upstream->allocate( capacity, BufferAlignment ) );
+    m_capacity = capacity;
+  }
+
+  m_offset = 0;
+}
+
+////////////////////////////////////////////////////////////
+// PROTECTED
+void * EmbeddedFrameArena::do_allocate( std::size_t bytes, std::size_t alignment )
+{
+  const auto base = reinterpret_cast< std::uintptr_t >( m_buffer );
+  const auto aligned = ( base + m_offset + alignment - 1 ) & ~( static_cast< std::uintptr_t >( alignment ) - 1 );
+  const auto end = aligned - base + bytes;
+
+  if ( end <= m_capacity )
+  {
+    m_offset = end;
+    return reinterpret_cast< void * >( aligned );
+  }
+
+  // out of room for this frame. fall back to the heap and keep track of
+  // the block so that it is released on reset
+  auto * block = static_cast< OverflowBlock * >( m_upstream->allocate( sizeof( OverflowBlock ), alignof( OverflowBlock ) ) );
+
+  block->memory = m_upstream->allocate( bytes, alignment );
+  block->size = bytes;
+  block->alignment = alignment;
+  block->next = m_overflow;
+
+  m_overflow = block;
+  m_overflowBytes += bytes;
+  ++m_overflowCount;
+
+  return block->memory;
+}
+
+////////////////////////////////////////////////////////////
+// PROTECTED
+void EmbeddedFrameArena::do_deallocate( void * ptr, std::size_t bytes, std::size_t alignment )
+{
+  // everything is released in bulk on reset
+  std::ignore = ptr;
+  std::ignore = bytes;
+  std::ignore = alignment;
+}
+
+////////////////////////////////////////////////////////////
+// PROTECTED
+bool EmbeddedFrameArena::do_is_equal( const std::pmr::memory_resource& other ) const noexcept
+{
+  return this == &other;
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+void EmbeddedFrameArena::releaseOverflow()
+{
+  while ( m_overflow != nullptr )
+  {
+    auto * next = m_overflow->next;
+    m_upstream->deallocate( m_overflow->memory, m_overflow->size, m_overflow->alignment );
+    m_upstream->deallocate( m_overflow, sizeof( OverflowBlock ), alignof( OverflowBlock ) );
+    m_overflow = next;
+  }
+
+  m_overflowBytes = 0;
+}
+
+}
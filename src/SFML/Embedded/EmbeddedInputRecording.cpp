@@ -0,0 +1,288 @@
+#include "SFML/Embedded/EmbeddedInputRecording.hpp"
+#include "SFML/Embedded/EmbeddedLogger.hpp"
+
+#include <fstream>
+#include <iterator>
+
+namespace
+{
+
+constexpr char Magic[ 4 ] = { 'S', 'F', 'E', 'R' };
+constexpr uint8_t Version = 1;
+
+// the native messages recordings capture
+#ifdef WIN32
+constexpr uint32_t MessageSetFocus = 0x0007;    // WM_SETFOCUS
+constexpr uint32_t MessageKillFocus = 0x0008;   // WM_KILLFOCUS
+constexpr uint32_t MessageKeyFirst = 0x0100;    // WM_KEYFIRST
+constexpr uint32_t MessageKeyLast = 0x0109;     // WM_KEYLAST
+constexpr uint32_t MessageMouseFirst = 0x0200;  // WM_MOUSEFIRST
+constexpr uint32_t MessageMouseLast = 0x020E;   // WM_MOUSELAST
+constexpr uint32_t MessageMouseLeave = 0x02A3;  // WM_MOUSELEAVE
+#else
+// X11 core event types, KeyPress to FocusOut. XInput2's are the same
+constexpr uint32_t MessageInputFirst = 2;
+constexpr uint32_t MessageInputLast = 10;
+#endif
+
+////////////////////////////////////////////////////////////
+void writeVarint( std::string& out, uint64_t value )
+{
+  while ( value >= 0x80 )
+  {
+    out += static_cast< char >( ( value & 0x7F ) | 0x80 );
+    value >>= 7;
+  }
+
+  out += static_cast< char >( value );
+}
+
+////////////////////////////////////////////////////////////
+// small negative deltas stay small
+void writeSigned( std::string& out, int64_t value )
+{
+  writeVarint( out, ( static_cast< uint64_t >( value ) << 1 ) ^ static_cast< uint64_t >( value >> 63 ) );
+}
+
+////////////////////////////////////////////////////////////
+class Reader
+{
+public:
+
+  explicit Reader( const std::string& data ) : m_data( data ) {}
+
+  bool readVarint( uint64_t& value )
+  {
+    value = 0;
+    for ( int shift = 0; shift < 64; shift += 7 )
+    {
+      if ( m_offset >= m_data.size() )
+        return false;
+
+      const auto byte = static_cast< uint8_t >( m_data[ m_offset++ ] );
+      value |= static_cast< uint64_t >( byte & 0x7F ) << shift;
+
+      if ( ( byte & 0x80 ) == 0 )
+        return true;
+    }
+
+    return false;
+  }
+
+  bool readSigned( int64_t& value )
+  {
+    uint64_t encoded = 0;
+    if ( !readVarint( encoded ) )
+      return false;
+
+    value = static_cast< int64_t >( encoded >> 1 ) ^ -static_cast< int64_t >( encoded & 1 );
+    return true;
+  }
+
+  bool readBytes( char * bytes, std::size_t count )
+  {
+    if ( m_data.size() - m_offset < count )
+      return false;
+
+    m_data.copy( bytes, count, m_offset );
+    m_offset += count;
+    return true;
+  }
+
+private:
+
+  const std::string& m_data;
+  std::size_t m_offset { 0 };
+};
+
+}
+
+namespace sf
+{
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedInputRecording::clear()
+{
+  m_frames.clear();
+  m_inputs.clear();
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedInputRecording::addFrame( sf::Time time, const sf::Vector2i& cursor, const sf::Vector2u& size )
+{
+  EmbeddedRecordedFrame frame;
+  frame.time = time;
+  frame.cursor = cursor;
+  frame.size = size;
+  frame.firstInput = m_frames.empty() ? 0 : m_frames.back().firstInput + m_frames.back().inputCount;
+  frame.inputCount = static_cast< uint32_t >( m_inputs.size() ) - frame.firstInput;
+  m_frames.push_back( frame );
+}
+
+////////////////////////////////////////////////////////////
+// STATIC PUBLIC
+[[nodiscard]]
+bool EmbeddedInputRecording::isRecordedMessage( uint32_t message )
+{
+  // everything SFML turns into an input or focus event
+#ifdef WIN32
+  return ( message >= MessageMouseFirst && message <= MessageMouseLast ) ||
+         ( message >= MessageKeyFirst && message <= MessageKeyLast ) ||
+         message == MessageMouseLeave ||
+         message == MessageSetFocus ||
+         message == MessageKillFocus;
+#else
+  return message >= MessageInputFirst && message <= MessageInputLast;
+#endif
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+bool EmbeddedInputRecording::saveToFile( const std::string& filename ) const
+{
+  std::string data( Magic, sizeof( Magic ) );
+  data += static_cast< char >( Version );
+
+  writeVarint( data, m_frames.size() );
+  writeVarint( data, m_inputs.size() );
+
+  // everything is stored as a delta from the previous frame or input
+  EmbeddedRecordedFrame previousFrame;
+  for ( const auto& frame : m_frames )
+  {
+    writeVarint( data, static_cast< uint64_t >( ( frame.time - previousFrame.time ).asMicroseconds() ) );
+    writeSigned( data, frame.cursor.x - previousFrame.cursor.x );
+    writeSigned( data, frame.cursor.y - previousFrame.cursor.y );
+    writeSigned( data, static_cast< int64_t >( frame.size.x ) - previousFrame.size.x );
+    writeSigned( data, static_cast< int64_t >( frame.size.y ) - previousFrame.size.y );
+    writeVarint( data, frame.inputCount );
+    previousFrame = frame;
+  }
+
+  EmbeddedRecordedInput previousInput;
+  for ( const auto& input : m_inputs )
+  {
+    writeVarint( data, input.message );
+    writeVarint( data, input.wParam );
+    writeSigned( data, input.lParam - previousInput.lParam );
+    previousInput = input;
+  }
+
+  std::ofstream file( filename, std::ios::binary | std::ios::trunc );
+  if ( !file.write( data.data(), static_cast< std::streamsize >( data.size() ) ) )
+  {
+    LOG_ERROR( "unable to write input recording {}", filename );
+    return false;
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+bool EmbeddedInputRecording::loadFromFile( const std::string& filename )
+{
+  std::ifstream file( filename, std::ios::binary );
+  if ( !file )
+  {
+    LOG_ERROR( "unable to open input recording {}", filename );
+    return false;
+  }
+
+  const std::string data( ( std::istreambuf_iterator< char >( file ) ), std::istreambuf_iterator< char >() );
+  Reader reader( data );
+
+  char magic[ sizeof( Magic ) ] {};
+  char version = 0;
+  uint64_t frameCount = 0;
+  uint64_t inputCount = 0;
+
+  if ( !reader.readBytes( magic, sizeof( magic ) ) ||
+       std::char_traits< char >::compare( magic, Magic, sizeof( Magic ) ) != 0 ||
+       !reader.readBytes( &version, 1 ) ||
+       static_cast< uint8_t >( version ) != Version ||
+       !reader.readVarint( frameCount ) ||
+       !reader.readVarint( inputCount ) ||
+       frameCount > data.size() ||
+       inputCount > data.size() )
+  {
+    LOG_ERROR( "{} is not an input recording", filename );
+    return false;
+  }
+
+  std::vector< EmbeddedRecordedFrame > frames( frameCount );
+  std::vector< EmbeddedRecordedInput > inputs( inputCount );
+
+  EmbeddedRecordedFrame previousFrame;
+  uint64_t firstInput = 0;
+  for ( auto& frame : frames )
+  {
+    uint64_t time = 0;
+    int64_t cursorX = 0;
+    int64_t cursorY = 0;
+    int64_t width = 0;
+    int64_t height = 0;
+    uint64_t count = 0;
+
+    if ( !reader.readVarint( time ) ||
+         !reader.readSigned( cursorX ) ||
+         !reader.readSigned( cursorY ) ||
+         !reader.readSigned( width ) ||
+         !reader.readSigned( height ) ||
+         !reader.readVarint( count ) ||
+         count > inputCount - firstInput )
+    {
+      LOG_ERROR( "input recording {} is truncated", filename );
+      return false;
+    }
+
+    frame.time = previousFrame.time + sf::microseconds( static_cast< int64_t >( time ) );
+    frame.cursor = { previousFrame.cursor.x + static_cast< int >( cursorX ),
+                     previousFrame.cursor.y + static_cast< int >( cursorY ) };
+    frame.size = { static_cast< unsigned int >( previousFrame.size.x + width ),
+                   static_cast< unsigned int >( previousFrame.size.y + height ) };
+    frame.firstInput = static_cast< uint32_t >( firstInput );
+    frame.inputCount = static_cast< uint32_t >( count );
+
+    firstInput += count;
+    previousFrame = frame;
+  }
+
+  // every input belongs to exactly one frame
+  if ( firstInput != inputCount )
+  {
+    LOG_ERROR( "input recording {} has inputs outside of its frames", filename );
+    return false;
+  }
+
+  int64_t previousLParam = 0;
+  for ( auto& input : inputs )
+  {
+    uint64_t message = 0;
+    int64_t lParam = 0;
+
+    if ( !reader.readVarint( message ) || !reader.readVarint( input.wParam ) || !reader.readSigned( lParam ) )
+    {
+      LOG_ERROR( "input recording {} is truncated", filename );
+      return false;
+    }
+
+    if ( message > UINT32_MAX || !isRecordedMessage( static_cast< uint32_t >( message ) ) )
+    {
+      LOG_ERROR( "input recording {} holds message {}, which isn't input", filename, message );
+      return false;
+    }
+
+    input.message = static_cast< uint32_t >( message );
+    input.lParam = previousLParam + lParam;
+    previousLParam = input.lParam;
+  }
+
+  m_frames = std::move( frames );
+  m_inputs = std::move( inputs );
+  return true;
+}
+
+}
@@ -0,0 +1,74 @@
+#include "SFML/Embedded/EmbeddedLatencyHistogram.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace sf
+{
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedLatencyHistogram::add( sf::Time latency )
+{
+  const auto microseconds = std::max< int64_t >( 0, latency.asMicroseconds() );
+  const auto bucket = std::min< int64_t >( microseconds / BucketWidthInUS, BucketCount - 1 );
+
+  ++m_buckets[ static_cast< std::size_t >( bucket ) ];
+
+  m_minInUS = m_count == 0 ? microseconds : std::min( m_minInUS, microseconds );
+  m_maxInUS = std::max( m_maxInUS, microseconds );
+  m_totalInUS += microseconds;
+  ++m_count;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedLatencyHistogram::reset()
+{
+  *this = EmbeddedLatencyHistogram {};
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+sf::Time EmbeddedLatencyHistogram::getMin() const
+{
+  return sf::microseconds( m_minInUS );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+sf::Time EmbeddedLatencyHistogram::getMax() const
+{
+  return sf::microseconds( m_maxInUS );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+sf::Time EmbeddedLatencyHistogram::getMean() const
+{
+  return m_count > 0 ? sf::microseconds( m_totalInUS / static_cast< int64_t >( m_count ) ) : sf::Time::Zero;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+sf::Time EmbeddedLatencyHistogram::getPercentile( float percentile ) const
+{
+  if ( m_count == 0 )
+    return sf::Time::Zero;
+
+  // rank of the sample we're after, counting from 1
+  const auto clamped = std::clamp( percentile, 0.f, 100.f );
+  const auto rank = std::max< uint64_t >( 1, static_cast< uint64_t >( std::ceil( clamped / 100.f * m_count ) ) );
+
+  uint64_t seen = 0;
+  for ( uint32_t i = 0; i < BucketCount; ++i )
+  {
+    seen += m_buckets[ i ];
+    if ( seen >= rank )
+      return sf::microseconds( std::min( ( i + 1 ) * BucketWidthInUS, m_maxInUS ) );
+  }
+
+  return getMax();
+}
+
+}
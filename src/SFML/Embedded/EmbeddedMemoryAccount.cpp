@@ -0,0 +1,202 @@
+#include "SFML/Embedded/EmbeddedMemoryAccount.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <utility>
+
+namespace
+{
+
+struct AccountRegistry
+{
+  std::mutex mutex;
+
+  // every account alive in the process, for the reports
+  std::vector< const sf::EmbeddedMemoryAccount * > accounts;
+};
+
+////////////////////////////////////////////////////////////
+AccountRegistry& getRegistry()
+{
+  static AccountRegistry registry;
+  return registry;
+}
+
+}
+
+namespace sf
+{
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+uint64_t EmbeddedMemoryUsage::getGpuBytes() const
+{
+  uint64_t total = 0;
+  for ( int kind = 0; kind < E_MemoryKindCount; ++kind )
+  {
+    if ( EmbeddedMemoryAccount::isGpuMemory( static_cast< E_EmbeddedMemoryKind >( kind ) ) )
+      total += bytes[ kind ];
+  }
+
+  return total;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+uint64_t EmbeddedMemoryUsage::getCpuBytes() const
+{
+  uint64_t total = 0;
+  for ( int kind = 0; kind < E_MemoryKindCount; ++kind )
+  {
+    if ( !EmbeddedMemoryAccount::isGpuMemory( static_cast< E_EmbeddedMemoryKind >( kind ) ) )
+      total += bytes[ kind ];
+  }
+
+  return total;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+EmbeddedMemoryAccount::EmbeddedMemoryAccount()
+{
+  auto& registry = getRegistry();
+  std::unique_lock< std::mutex > lock( registry.mutex );
+  registry.accounts.push_back( this );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+EmbeddedMemoryAccount::~EmbeddedMemoryAccount()
+{
+  auto& registry = getRegistry();
+  std::unique_lock< std::mutex > lock( registry.mutex );
+  registry.accounts.erase( std::remove( registry.accounts.begin(), registry.accounts.end(), this ),
+                           registry.accounts.end() );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedMemoryAccount::setLabel( const std::string& label )
+{
+  auto& registry = getRegistry();
+  std::unique_lock< std::mutex > lock( registry.mutex );
+  m_label = label;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+[[nodiscard]]
+bool EmbeddedMemoryAccount::isOverBudget() const
+{
+  const auto budget = getBudget();
+  return budget != 0 && getUsage().getTotalBytes() > budget;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+[[nodiscard]]
+EmbeddedMemoryUsage EmbeddedMemoryAccount::getUsage() const
+{
+  EmbeddedMemoryUsage usage;
+
+  for ( int kind = 0; kind < E_MemoryKindCount; ++kind )
+    usage.bytes[ kind ] = m_bytes[ kind ].load( std::memory_order_relaxed );
+
+  usage.budget = getBudget();
+  return usage;
+}
+
+////////////////////////////////////////////////////////////
+// STATIC PUBLIC
+[[nodiscard]]
+bool EmbeddedMemoryAccount::isGpuMemory( E_EmbeddedMemoryKind kind )
+{
+  return kind == E_MemoryFramebuffer || kind == E_MemoryRenderTextures || kind == E_MemoryTextures;
+}
+
+////////////////////////////////////////////////////////////
+// STATIC PUBLIC
+[[nodiscard]]
+std::vector< EmbeddedMemoryUsage > EmbeddedMemoryAccount::getProcessReport()
+{
+  auto& registry = getRegistry();
+  std::unique_lock< std::mutex > lock( registry.mutex );
+
+  std::vector< EmbeddedMemoryUsage > report;
+  report.reserve( registry.accounts.size() );
+
+  for ( const auto * account : registry.accounts )
+  {
+    report.push_back( account->getUsage() );
+    report.back().label = account->m_label;
+  }
+
+  return report;
+}
+
+////////////////////////////////////////////////////////////
+// STATIC PUBLIC
+[[nodiscard]]
+EmbeddedMemoryUsage EmbeddedMemoryAccount::getProcessTotal()
+{
+  EmbeddedMemoryUsage total;
+  total.label = "process";
+
+  for ( const auto& usage : getProcessReport() )
+  {
+    for ( int kind = 0; kind < E_MemoryKindCount; ++kind )
+      total.bytes[ kind ] += usage.bytes[ kind ];
+
+    total.budget += usage.budget;
+  }
+
+  return total;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+EmbeddedMemoryCharge::EmbeddedMemoryCharge( std::shared_ptr< EmbeddedMemoryAccount > account,
+                                            E_EmbeddedMemoryKind kind )
+  : m_account( std::move( account ) )
+  , m_kind( kind )
+{}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+EmbeddedMemoryCharge::EmbeddedMemoryCharge( EmbeddedMemoryCharge&& other ) noexcept
+  : m_account( std::move( other.m_account ) )
+  , m_kind( other.m_kind )
+  , m_bytes( std::exchange( other.m_bytes, 0 ) )
+{}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+EmbeddedMemoryCharge& EmbeddedMemoryCharge::operator=( EmbeddedMemoryCharge&& other ) noexcept
+{
+  if ( this != &other )
+  {
+    setBytes( 0 );
+    m_account = std::move( other.m_account );
+    m_kind = other.m_kind;
+    m_bytes = std::exchange( other.m_bytes, 0 );
+  }
+
+  return *this;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedMemoryCharge::setBytes( uint64_t bytes )
+{
+  if ( !m_account )
+    return;
+
+  if ( bytes > m_bytes )
+    m_account->add( m_kind, bytes - m_bytes );
+  else if ( bytes < m_bytes )
+    m_account->release( m_kind, m_bytes - bytes );
+
+  m_bytes = bytes;
+}
+
+}
@@ -0,0 +1,214 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace sf::priv
+{
+
+// both processes map the same memory, so nothing in it may rely on a lock
+static_assert( std::atomic< uint32_t >::is_always_lock_free, "shared atomics must be lock-free" );
+static_assert( std::atomic< int64_t >::is_always_lock_free, "shared atomics must be lock-free" );
+static_assert( std::atomic< uint64_t >::is_always_lock_free, "shared atomics must be lock-free" );
+
+////////////////////////////////////////////////////////////
+/// \brief A native input message forwarded from the host to the helper
+////////////////////////////////////////////////////////////
+struct EmbeddedRemoteInput
+{
+  uint32_t message;
+  uint32_t reserved;
+  uint64_t wParam;
+  int64_t lParam;
+};
+
+////////////////////////////////////////////////////////////
+/// \brief Header at the start of the shared memory between the host
+/// (presenter) and the helper (renderer)
+///
+/// Layout of the shared memory:
+///   [ header ][ frame 0 ][ frame 1 ][ frame 2 ]
+///
+/// Frames are 32-bit BGRA, bottom-up, which is both what glReadPixels
+/// produces and what a bottom-up DIB expects, so a frame is never copied
+/// or flipped between the GPU readback and the blit.
+///
+/// Only lock-free atomics live in here since both processes map it.
+////////////////////////////////////////////////////////////
+struct EmbeddedRemoteHeader
+{
+  static constexpr uint32_t Magic = 0x53464D45;   // "SFME"
+  static constexpr uint32_t Version = 1;
+  static constexpr uint32_t InputCapacity = 256;  // power of 2
+
+  // set in the index exchanged through the triple buffer when it holds an unseen frame
+  static constexpr uint32_t FreshFrameBit = 0x4;
+  static constexpr uint32_t FrameIndexMask = 0x3;
+
+  uint32_t magic;
+  uint32_t version;
+  uint32_t width;
+  uint32_t height;
+
+  // lets the helper exit when the host goes away without closing the channel
+  uint32_t hostProcessId;
+
+  // triple buffer: the helper owns one frame, the host owns one frame,
+  // and the third is swapped between them through this index
+  std::atomic< uint32_t > sharedFrame;
+
+  // QPC ticks at which each frame was published (for latency measurement)
+  std::atomic< int64_t > publishTicks[ 3 ];
+  std::atomic< uint64_t > publishedFrames;
+
+  // host -> helper input (single producer, single consumer)
+  std::atomic< uint32_t > inputWrite;
+  std::atomic< uint32_t > inputRead;
+  EmbeddedRemoteInput inputs[ InputCapacity ];
+
+  // host -> helper cursor snapshot relative to the presenter window
+  std::atomic< int32_t > cursorX;
+  std::atomic< int32_t > cursorY;
+
+  // host -> helper request to shut down
+  std::atomic< uint32_t > shutdown;
+};
+
+////////////////////////////////////////////////////////////
+/// \brief Operations on the shared memory. Used by both processes.
+////////////////////////////////////////////////////////////
+class EmbeddedRemoteChannel
+{
+public:
+
+  /// \brief gets the number of bytes to map for a given frame size
+  static std::size_t getMappingSize( uint32_t width, uint32_t height )
+  {
+    return getFrameOffset( 0 ) + 3 * getFrameSize( width, height );
+  }
+
+  /// \brief gets the size of one frame in bytes
+  static std::size_t getFrameSize( uint32_t width, uint32_t height )
+  {
+    return static_cast< std::size_t >( width ) * height * 4;
+  }
+
+  /// \brief gets the offset of a frame from the start of the mapping. page aligned.
+  static std::size_t getFrameOffset( uint32_t index, uint32_t width = 0, uint32_t height = 0 )
+  {
+    constexpr std::size_t pageSize = 4096;
+    const std::size_t headerSize = ( sizeof( EmbeddedRemoteHeader ) + pageSize - 1 ) & ~( pageSize - 1 );
+    return headerSize + index * getFrameSize( width, height );
+  }
+
+  explicit EmbeddedRemoteChannel( void * mapping )
+    : m_header( static_cast< EmbeddedRemoteHeader * >( mapping ) ),
+      m_base( static_cast< uint8_t * >( mapping ) )
+  {}
+
+  /// \brief prepares freshly created shared memory. host only.
+  void initialize( uint32_t width, uint32_t height, uint32_t hostProcessId )
+  {
+    m_header->magic = EmbeddedRemoteHeader::Magic;
+    m_header->version = EmbeddedRemoteHeader::Version;
+    m_header->width = width;
+    m_header->height = height;
+    m_header->hostProcessId = hostProcessId;
+
+    // frame 0 belongs to the helper, frame 1 to the host and frame 2 is shared
+    m_header->sharedFrame.store( 2, std::memory_order_relaxed );
+    for ( auto& ticks : m_header->publishTicks )
+      ticks.store( 0, std::memory_order_relaxed );
+
+    m_header->publishedFrames.store( 0, std::memory_order_relaxed );
+    m_header->inputWrite.store( 0, std::memory_order_relaxed );
+    m_header->inputRead.store( 0, std::memory_order_relaxed );
+    m_header->cursorX.store( 0, std::memory_order_relaxed );
+    m_header->cursorY.store( 0, std::memory_order_relaxed );
+    m_header->shutdown.store( 0, std::memory_order_release );
+  }
+
+  /// \brief checks that the mapping was created by a compatible host
+  [[nodiscard]]
+  bool isValid() const
+  {
+    return m_header->magic == EmbeddedRemoteHeader::Magic &&
+           m_header->version == EmbeddedRemoteHeader::Version;
+  }
+
+  [[nodiscard]]
+  EmbeddedRemoteHeader& getHeader() const { return *m_header; }
+
+  /// \brief gets the pixels of a frame
+  [[nodiscard]]
+  uint8_t * getFrame( uint32_t index ) const
+  {
+    return m_base + getFrameOffset( index, m_header->width, m_header->height );
+  }
+
+  ////////////////////////////////////////////////////////////
+  /// \brief Publishes the frame the helper just rendered. Helper only.
+  /// \param frame the helper's frame index. receives the frame to render next
+  /// \param ticks QPC ticks at the time of publishing
+  ////////////////////////////////////////////////////////////
+  void publish( uint32_t& frame, int64_t ticks )
+  {
+    m_header->publishTicks[ frame ].store( ticks, std::memory_order_relaxed );
+    m_header->publishedFrames.fetch_add( 1, std::memory_order_relaxed );
+
+    const auto previous = m_header->sharedFrame.exchange( frame | EmbeddedRemoteHeader::FreshFrameBit,
+                                                          std::memory_order_acq_rel );
+    frame = previous & EmbeddedRemoteHeader::FrameIndexMask;
+  }
+
+  ////////////////////////////////////////////////////////////
+  /// \brief Takes the latest published frame, if there is one. Host only.
+  /// \param frame the host's frame index. receives the newest frame
+  /// \return false if nothing new was published since the last call
+  ////////////////////////////////////////////////////////////
+  bool acquire( uint32_t& frame )
+  {
+    if ( ( m_header->sharedFrame.load( std::memory_order_relaxed ) & EmbeddedRemoteHeader::FreshFrameBit ) == 0 )
+      return false;
+
+    const auto previous = m_header->sharedFrame.exchange( frame, std::memory_order_acq_rel );
+    frame = previous & EmbeddedRemoteHeader::FrameIndexMask;
+    return true;
+  }
+
+  /// \brief queues an input message for the helper. host only. returns false if the ring is full
+  bool pushInput( const EmbeddedRemoteInput& input )
+  {
+    const auto write = m_header->inputWrite.load( std::memory_order_relaxed );
+    const auto read = m_header->inputRead.load( std::memory_order_acquire );
+
+    if ( write - read >= EmbeddedRemoteHeader::InputCapacity )
+      return false;
+
+    m_header->inputs[ write & ( EmbeddedRemoteHeader::InputCapacity - 1 ) ] = input;
+    m_header->inputWrite.store( write + 1, std::memory_order_release );
+    return true;
+  }
+
+  /// \brief takes the next input message. helper only. returns false if the ring is empty
+  bool popInput( EmbeddedRemoteInput& input )
+  {
+    const auto read = m_header->inputRead.load( std::memory_order_relaxed );
+    const auto write = m_header->inputWrite.load( std::memory_order_acquire );
+
+    if ( read == write )
+      return false;
+
+    input = m_header->inputs[ read & ( EmbeddedRemoteHeader::InputCapacity - 1 ) ];
+    m_header->inputRead.store( read + 1, std::memory_order_release );
+    return true;
+  }
+
+private:
+
+  EmbeddedRemoteHeader * m_header { nullptr };
+  uint8_t * m_base { nullptr };
+};
+
+}
@@ -0,0 +1,19 @@
+#include "EmbeddedRemotePresenter.hpp"
+
+#ifdef WIN32
+#include "EmbeddedRemotePresenterWin32.hpp"
+using EmbeddedRemotePresenterType = sf::priv::EmbeddedRemotePresenterWin32;
+#endif
+
+namespace sf::priv
+{
+
+EmbeddedRemotePresenter * EmbeddedRemotePresenter::create(
+  ::sf::WindowHandle parentHandle,
+  const std::string& helperPath,
+  const sf::Vector2u& size )
+{
+  return new EmbeddedRemotePresenterType( parentHandle, helperPath, size );
+}
+
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+
+#include <SFML/Window/WindowHandle.hpp>
+#include <SFML/System/Vector2.hpp>
+
+#include "SFML/Embedded/EmbeddedRemoteWindow.hpp"
+
+namespace sf::priv
+{
+
+////////////////////////////////////////////////////////////
+/// \brief Platform-specific host side of an EmbeddedRemoteWindow
+////////////////////////////////////////////////////////////
+class EmbeddedRemotePresenter
+{
+public:
+
+  [[nodiscard]]
+  static EmbeddedRemotePresenter * create( WindowHandle parentHandle,
+                                           const std::string& helperPath,
+                                           const sf::Vector2u& size );
+
+  virtual ~EmbeddedRemotePresenter() = default;
+
+  [[nodiscard]]
+  virtual WindowHandle getNativeHandle() const { return nullptr; }
+
+  [[nodiscard]]
+  virtual WindowHandle getParentNativeHandle() const { return nullptr; }
+
+  [[nodiscard]]
+  virtual bool isHelperRunning() const { return false; }
+
+  [[nodiscard]]
+  virtual EmbeddedRemoteStats getStats() const { return {}; }
+};
+
+}
@@ -0,0 +1,556 @@
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+
+#include "EmbeddedRemotePresenterWin32.hpp"
+#include "EmbeddedWindowImplWin32.hpp"
+#include "SFML/Embedded/EmbeddedRemoteRenderer.hpp"
+#include "SFML/Embedded/EmbeddedLogger.hpp"
+#include "SFML/Embedded/EmbeddedTracer.hpp"
+#include "SFML/Embedded/EmbeddedDiagnostics.hpp"
+
+#include <algorithm>
+#include <string>
+#include <tuple>
+
+#include <windowsx.h>
+
+namespace sf::priv
+{
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+EmbeddedRemotePresenterWin32::EmbeddedRemotePresenterWin32(sf::WindowHandle parentHandle,
+                                                           const std::string& helperPath,
+                                                           const sf::Vector2u& size)
+    : m_parentHwnd( parentHandle )
+{
+    ::LARGE_INTEGER frequency {};
+    ::QueryPerformanceFrequency( &frequency );
+    m_ticksPerSecond = frequency.QuadPart;
+
+    // if the size is 0 then use the parent's size
+    auto frameSize = size;
+    if ( frameSize.x == 0 || frameSize.y == 0 )
+    {
+        ::RECT parentRect {};
+        ::GetClientRect( m_parentHwnd, &parentRect );
+        frameSize = { ( uint32_t )( parentRect.right - parentRect.left ),
+                      ( uint32_t )( parentRect.bottom - parentRect.top ) };
+    }
+
+    if ( frameSize.x == 0 || frameSize.y == 0 )
+    {
+        LOG_ERROR( "remote window size is empty" );
+        return;
+    }
+
+    m_size = frameSize;
+
+    if ( createChannel( m_size ) &&
+         createWindow( m_size ) &&
+         createFrameBitmaps( m_size ) &&
+         launchHelper( helperPath ) &&
+         registerWaits() )
+    {
+        LOG_INFO( "remote window is waiting for frames from {}", helperPath );
+    }
+    else
+        LOG_ERROR( "failed to set up remote window" );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+EmbeddedRemotePresenterWin32::~EmbeddedRemotePresenterWin32()
+{
+    // ask the helper to exit on its own first
+    if ( m_channel )
+        m_channel->getHeader().shutdown.store( 1, std::memory_order_release );
+
+    // INVALID_HANDLE_VALUE waits for running callbacks, which post to m_childHwnd
+    if ( m_frameWait != nullptr )
+        ::UnregisterWaitEx( m_frameWait, INVALID_HANDLE_VALUE );
+
+    if ( m_exitWait != nullptr )
+        ::UnregisterWaitEx( m_exitWait, INVALID_HANDLE_VALUE );
+
+    if ( m_helperProcess != nullptr )
+    {
+        if ( ::WaitForSingleObject( m_helperProcess, HelperExitTimeoutInMS ) != WAIT_OBJECT_0 )
+        {
+            LOG_WARN( "helper did not exit in time. terminating it." );
+            ::TerminateProcess( m_helperProcess, EXIT_FAILURE );
+        }
+
+        ::CloseHandle( m_helperProcess );
+    }
+
+    if ( m_childHwnd != nullptr )
+    {
+        ::DestroyWindow( m_childHwnd );
+        EmbeddedDiagnostics::release( E_ResourceNativeWindow );
+
+        std::unique_lock< std::mutex > lock( smClassMutex );
+        if ( --smClassUsers == 0 )
+        {
+            ::UnregisterClassA( smClassname.c_str(), EmbeddedWindowImplWin32::Win32Helper::getModuleInstance() );
+            EmbeddedDiagnostics::release( E_ResourceWindowClass );
+            smClassname.clear();
+        }
+    }
+
+    if ( m_memoryDc != nullptr )
+        ::DeleteDC( m_memoryDc );
+
+    for ( auto bitmap : m_frameBitmaps )
+    {
+        if ( bitmap != nullptr )
+            ::DeleteObject( bitmap );
+    }
+
+    m_channel.reset();
+
+    if ( m_view != nullptr )
+        ::UnmapViewOfFile( m_view );
+
+    for ( auto handle : { m_mapping, m_frameEvent } )
+    {
+        if ( handle != nullptr )
+            ::CloseHandle( handle );
+    }
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+sf::WindowHandle EmbeddedRemotePresenterWin32::getNativeHandle() const
+{
+    return m_childHwnd;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+sf::WindowHandle EmbeddedRemotePresenterWin32::getParentNativeHandle() const
+{
+    return m_parentHwnd;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+bool EmbeddedRemotePresenterWin32::isHelperRunning() const
+{
+    return m_isHelperRunning.load( std::memory_order_acquire );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+EmbeddedRemoteStats EmbeddedRemotePresenterWin32::getStats() const
+{
+    const auto toTime = [ this ]( int64_t ticks )
+    {
+        return sf::microseconds( ticks * 1000000 / m_ticksPerSecond );
+    };
+
+    EmbeddedRemoteStats stats;
+    stats.publishedFrames = m_channel ? m_channel->getHeader().publishedFrames.load( std::memory_order_relaxed ) : 0;
+    stats.presentedFrames = m_presentedFrames;
+    stats.droppedInputs = m_droppedInputs;
+    stats.lastLatency = toTime( m_lastLatencyTicks );
+    stats.maxLatency = toTime( m_maxLatencyTicks );
+    stats.averageLatency = m_presentedFrames > 0
+                           ? toTime( m_totalLatencyTicks / static_cast< int64_t >( m_presentedFrames ) )
+                           : sf::Time::Zero;
+    stats.isHelperRunning = isHelperRunning();
+    return stats;
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+bool EmbeddedRemotePresenterWin32::createChannel( const sf::Vector2u& size )
+{
+    m_channelName = "Local\\sfml-embedded-" +
+                    std::to_string( ::GetCurrentProcessId() ) + "-" +
+                    std::to_string( smChannelCounter++ );
+
+    const auto mappingSize = static_cast< uint64_t >( EmbeddedRemoteChannel::getMappingSize( size.x, size.y ) );
+
+    m_mapping = ::CreateFileMappingA( INVALID_HANDLE_VALUE,
+                                      nullptr,
+                                      PAGE_READWRITE,
+                                      static_cast< DWORD >( mappingSize >> 32 ),
+                                      static_cast< DWORD >( mappingSize & 0xFFFFFFFF ),
+                                      m_channelName.c_str() );
+
+    if ( m_mapping == nullptr )
+    {
+        LOG_ERROR( "failed to create shared memory. Error code: {}", ::GetLastError() );
+        return false;
+    }
+
+    m_view = ::MapViewOfFile( m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0 );
+    if ( m_view == nullptr )
+    {
+        LOG_ERROR( "failed to map shared memory. Error code: {}", ::GetLastError() );
+        return false;
+    }
+
+    m_channel = std::make_unique< EmbeddedRemoteChannel >( m_view );
+    m_channel->initialize( size.x, size.y, ::GetCurrentProcessId() );
+
+    // auto-reset: one wake-up per published frame (or per burst of frames)
+    m_frameEvent = ::CreateEventA( nullptr, FALSE, FALSE, ( m_channelName + "-frame" ).c_str() );
+    if ( m_frameEvent == nullptr )
+    {
+        LOG_ERROR( "failed to create frame event. Error code: {}", ::GetLastError() );
+        return false;
+    }
+
+    return true;
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+bool EmbeddedRemotePresenterWin32::createWindow( const sf::Vector2u& size )
+{
+    const auto hInstance = EmbeddedWindowImplWin32::Win32Helper::getModuleInstance();
+
+    {
+        std::unique_lock< std::mutex > lock( smClassMutex );
+        if ( smClassUsers == 0 )
+        {
+            smClassname = EmbeddedWindowImplWin32::Win32Helper::createUniqueName();
+            if ( smClassname.empty() )
+                return false;
+
+            ::WNDCLASSA wndClass {};
+            wndClass.style = CS_DBLCLKS;
+            wndClass.lpfnWndProc = processWndEvent;
+            wndClass.hInstance = hInstance;
+            wndClass.hCursor = ::LoadCursor( nullptr, IDC_ARROW );
+            wndClass.lpszClassName = smClassname.c_str();
+
+            if ( ::RegisterClassA( &wndClass ) == 0 )
+            {
+                LOG_ERROR( "failed to register window class. Error code: {}", ::GetLastError() );
+                smClassname.clear();
+                return false;
+            }
+
+            EmbeddedDiagnostics::acquire( E_ResourceWindowClass );
+        }
+
+        ++smClassUsers;
+    }
+
+    m_childHwnd = ::CreateWindowExA(
+        WS_EX_NOINHERITLAYOUT,
+        smClassname.c_str(),
+        "__presenterWindowName",
+        WS_CHILD | WS_CLIPCHILDREN | WS_CLIPSIBLINGS | WS_VISIBLE,
+        0,
+        0,
+        ( int )size.x,
+        ( int )size.y,
+        m_parentHwnd,
+        nullptr,
+        hInstance,
+        this );
+
+    if ( m_childHwnd == nullptr )
+    {
+        LOG_ERROR( "failed to create presenter window. Error Code: {}", ::GetLastError() );
+
+        std::unique_lock< std::mutex > lock( smClassMutex );
+        if ( --smClassUsers == 0 )
+        {
+            ::UnregisterClassA( smClassname.c_str(), hInstance );
+            EmbeddedDiagnostics::release( E_ResourceWindowClass );
+            smClassname.clear();
+        }
+
+        return false;
+    }
+
+    EmbeddedDiagnostics::acquire( E_ResourceNativeWindow );
+    return true;
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+bool EmbeddedRemotePresenterWin32::createFrameBitmaps( const sf::Vector2u& size )
+{
+    // positive height: bottom-up rows, the same order glReadPixels writes them in
+    ::BITMAPINFO bitmapInfo {};
+    bitmapInfo.bmiHeader.biSize = sizeof( ::BITMAPINFOHEADER );
+    bitmapInfo.bmiHeader.biWidth = ( LONG )size.x;
+    bitmapInfo.bmiHeader.biHeight = ( LONG )size.y;
+    bitmapInfo.bmiHeader.biPlanes = 1;
+    bitmapInfo.bmiHeader.biBitCount = 32;
+    bitmapInfo.bmiHeader.biCompression = BI_RGB;
+
+    for ( uint32_t i = 0; i < 3; ++i )
+    {
+        void * bits = nullptr;
+        const auto offset = EmbeddedRemoteChannel::getFrameOffset( i, size.x, size.y );
+
+        m_frameBitmaps[ i ] = ::CreateDIBSection( nullptr,
+                                                  &bitmapInfo,
+                                                  DIB_RGB_COLORS,
+                                                  &bits,
+                                                  m_mapping,
+                                                  static_cast< DWORD >( offset ) );
+
+        if ( m_frameBitmaps[ i ] == nullptr )
+        {
+            LOG_ERROR( "failed to create frame bitmap {}. Error code: {}", i, ::GetLastError() );
+            return false;
+        }
+    }
+
+    m_memoryDc = ::CreateCompatibleDC( nullptr );
+    return m_memoryDc != nullptr;
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+bool EmbeddedRemotePresenterWin32::launchHelper( const std::string& helperPath )
+{
+    std::string commandLine = "\"" + helperPath + "\" " +
+                              EmbeddedRemoteRenderer::ChannelArgument + m_channelName;
+
+    ::STARTUPINFOA startupInfo {};
+    startupInfo.cb = sizeof( startupInfo );
+    ::PROCESS_INFORMATION processInfo {};
+
+    if ( !::CreateProcessA( helperPath.c_str(),
+                            commandLine.data(),
+                            nullptr,
+                            nullptr,
+                            FALSE,
+                            0,
+                            nullptr,
+                            nullptr,
+                            &startupInfo,
+                            &processInfo ) )
+    {
+        LOG_ERROR( "failed to launch helper {}. Error code: {}", helperPath, ::GetLastError() );
+        return false;
+    }
+
+    ::CloseHandle( processInfo.hThread );
+    m_helperProcess = processInfo.hProcess;
+    m_isHelperRunning.store( true, std::memory_order_release );
+    return true;
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+bool EmbeddedRemotePresenterWin32::registerWaits()
+{
+    if ( !::RegisterWaitForSingleObject( &m_frameWait,
+                                         m_frameEvent,
+                                         processFrameSignal,
+                                         this,
+                                         INFINITE,
+                                         WT_EXECUTEINWAITTHREAD ) )
+    {
+        LOG_ERROR( "failed to wait for frames. Error code: {}", ::GetLastError() );
+        m_frameWait = nullptr;
+        return false;
+    }
+
+    if ( !::RegisterWaitForSingleObject( &m_exitWait,
+                                         m_helperProcess,
+                                         processHelperExit,
+                                         this,
+                                         INFINITE,
+                                         WT_EXECUTEINWAITTHREAD | WT_EXECUTEONLYONCE ) )
+    {
+        LOG_ERROR( "failed to watch helper process. Error code: {}", ::GetLastError() );
+        m_exitWait = nullptr;
+        return false;
+    }
+
+    return true;
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+void EmbeddedRemotePresenterWin32::presentLatestFrame()
+{
+    TRACE_SCOPE( "present remote frame" );
+
+    if ( !m_channel || !m_channel->acquire( m_frame ) )
+        return;
+
+    ::LARGE_INTEGER now {};
+    ::QueryPerformanceCounter( &now );
+
+    const auto published = m_channel->getHeader().publishTicks[ m_frame ].load( std::memory_order_relaxed );
+    m_lastLatencyTicks = std::max< int64_t >( 0, now.QuadPart - published );
+    m_maxLatencyTicks = std::max( m_maxLatencyTicks, m_lastLatencyTicks );
+    m_totalLatencyTicks += m_lastLatencyTicks;
+    ++m_presentedFrames;
+    m_hasFrame = true;
+
+    auto hdc = ::GetDC( m_childHwnd );
+    blit( hdc );
+    ::ReleaseDC( m_childHwnd, hdc );
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+void EmbeddedRemotePresenterWin32::blit( HDC hdc ) const
+{
+    if ( !m_hasFrame )
+    {
+        ::RECT rect { 0, 0, ( LONG )m_size.x, ( LONG )m_size.y };
+        ::FillRect( hdc, &rect, ( HBRUSH )::GetStockObject( BLACK_BRUSH ) );
+        return;
+    }
+
+    auto previous = ::SelectObject( m_memoryDc, m_frameBitmaps[ m_frame ] );
+    ::BitBlt( hdc, 0, 0, ( int )m_size.x, ( int )m_size.y, m_memoryDc, 0, 0, SRCCOPY );
+    ::SelectObject( m_memoryDc, previous );
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+void EmbeddedRemotePresenterWin32::forwardInput( UINT msg, WPARAM wParam, LPARAM lParam )
+{
+    if ( !m_channel )
+        return;
+
+    auto& header = m_channel->getHeader();
+
+    switch ( msg )
+    {
+        case WM_MOUSEMOVE:
+            header.cursorX.store( GET_X_LPARAM( lParam ), std::memory_order_relaxed );
+            header.cursorY.store( GET_Y_LPARAM( lParam ), std::memory_order_relaxed );
+            break;
+
+        case WM_LBUTTONDOWN:
+        case WM_RBUTTONDOWN:
+        case WM_MBUTTONDOWN:
+            // take the keyboard and keep receiving the drag outside of the window
+            ::SetFocus( m_childHwnd );
+            ::SetCapture( m_childHwnd );
+            break;
+
+        case WM_LBUTTONUP:
+        case WM_RBUTTONUP:
+        case WM_MBUTTONUP:
+            ::ReleaseCapture();
+            break;
+
+        case WM_MOUSEWHEEL:
+        case WM_MOUSEHWHEEL:
+        {
+            // screen coordinates mean nothing to the helper. send client coordinates
+            ::POINT point { GET_X_LPARAM( lParam ), GET_Y_LPARAM( lParam ) };
+            ::ScreenToClient( m_childHwnd, &point );
+            lParam = MAKELPARAM( point.x, point.y );
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    const EmbeddedRemoteInput input { msg, 0, static_cast< uint64_t >( wParam ), static_cast< int64_t >( lParam ) };
+    if ( !m_channel->pushInput( input ) )
+        ++m_droppedInputs;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// STATIC PRIVATE
+LRESULT EmbeddedRemotePresenterWin32::processWndEvent(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
+{
+    if ( msg == WM_NCCREATE )
+    {
+        auto * create = reinterpret_cast< ::CREATESTRUCTA * >( lParam );
+        ::SetWindowLongPtrA( hwnd, GWLP_USERDATA, reinterpret_cast< LONG_PTR >( create->lpCreateParams ) );
+    }
+
+    auto * presenter = reinterpret_cast< EmbeddedRemotePresenterWin32 * >( ::GetWindowLongPtrA( hwnd, GWLP_USERDATA ) );
+    if ( presenter == nullptr )
+        return ::DefWindowProcA( hwnd, msg, wParam, lParam );
+
+    switch ( msg )
+    {
+        case WM_PRESENT_FRAME:
+            presenter->m_isPresentPending.store( false, std::memory_order_release );
+            presenter->presentLatestFrame();
+            return 0;
+
+        case WM_HELPER_EXITED:
+            LOG_ERROR( "helper process exited. the last frame stays on screen." );
+            return 0;
+
+        case WM_PAINT:
+        {
+            ::PAINTSTRUCT paint {};
+            auto hdc = ::BeginPaint( hwnd, &paint );
+            presenter->blit( hdc );
+            ::EndPaint( hwnd, &paint );
+            return 0;
+        }
+
+        case WM_ERASEBKGND:
+            // every pixel is covered by the frame
+            return 1;
+
+        case WM_MOUSEMOVE:
+        case WM_LBUTTONDOWN:
+        case WM_LBUTTONUP:
+        case WM_LBUTTONDBLCLK:
+        case WM_RBUTTONDOWN:
+        case WM_RBUTTONUP:
+        case WM_RBUTTONDBLCLK:
+        case WM_MBUTTONDOWN:
+        case WM_MBUTTONUP:
+        case WM_MBUTTONDBLCLK:
+        case WM_MOUSEWHEEL:
+        case WM_MOUSEHWHEEL:
+        case WM_KEYDOWN:
+        case WM_KEYUP:
+        case WM_SYSKEYDOWN:
+        case WM_SYSKEYUP:
+        case WM_CHAR:
+        case WM_SETFOCUS:
+        case WM_KILLFOCUS:
+            presenter->forwardInput( msg, wParam, lParam );
+            break;
+
+        default:
+            break;
+    }
+
+    return ::DefWindowProcA( hwnd, msg, wParam, lParam );
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// STATIC PRIVATE
+void EmbeddedRemotePresenterWin32::processFrameSignal(PVOID context, BOOLEAN timedOut)
+{
+    std::ignore = timedOut;
+
+    // runs on a thread-pool thread. hand the frame over to the window's thread,
+    // but only once until that thread has caught up
+    auto * presenter = static_cast< EmbeddedRemotePresenterWin32 * >( context );
+    if ( !presenter->m_isPresentPending.exchange( true, std::memory_order_acq_rel ) )
+        ::PostMessageA( presenter->m_childHwnd, WM_PRESENT_FRAME, 0, 0 );
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// STATIC PRIVATE
+void EmbeddedRemotePresenterWin32::processHelperExit(PVOID context, BOOLEAN timedOut)
+{
+    std::ignore = timedOut;
+
+    auto * presenter = static_cast< EmbeddedRemotePresenterWin32 * >( context );
+    presenter->m_isHelperRunning.store( false, std::memory_order_release );
+    ::PostMessageA( presenter->m_childHwnd, WM_HELPER_EXITED, 0, 0 );
+}
+
+}
@@ -0,0 +1,176 @@
+#pragma once
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+
+#include <Windows.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <SFML/Window/WindowHandle.hpp>
+#include <SFML/System/Vector2.hpp>
+
+#include "EmbeddedRemotePresenter.hpp"
+#include "EmbeddedRemoteChannel.hpp"
+
+namespace sf::priv
+{
+
+////////////////////////////////////////////////////////////
+/// \brief Windows implementation of the host side of a remote window
+///
+/// Frames are presented straight out of the shared memory: each of the
+/// three frames is wrapped in a DIB section created on top of the file
+/// mapping, so presenting is a single BitBlt with no intermediate copy.
+/// The helper signals a named event after every frame; a thread-pool wait
+/// turns that into a window message, so frames are shown as soon as the
+/// host's message loop gets to them rather than on the next timer tick.
+////////////////////////////////////////////////////////////
+class EmbeddedRemotePresenterWin32 : public sf::priv::EmbeddedRemotePresenter
+{
+public:
+
+    // prevent default ctor and copying
+    EmbeddedRemotePresenterWin32() = delete;
+    EmbeddedRemotePresenterWin32(const EmbeddedRemotePresenterWin32& other) = delete;
+    EmbeddedRemotePresenterWin32& operator=(const EmbeddedRemotePresenterWin32& other) = delete;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Create the presenter window and launch the helper
+    ///
+    /// \param parentHandle Platform-specific handle of the parent control
+    /// \param helperPath path to the helper executable
+    /// \param size size of the frames (0 uses the parent's size)
+    ////////////////////////////////////////////////////////////
+    EmbeddedRemotePresenterWin32(sf::WindowHandle parentHandle,
+                                 const std::string& helperPath,
+                                 const sf::Vector2u& size);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Destructor
+    ///
+    ////////////////////////////////////////////////////////////
+    ~EmbeddedRemotePresenterWin32() override;
+
+    [[nodiscard]]
+    sf::WindowHandle getNativeHandle() const override;
+
+    [[nodiscard]]
+    sf::WindowHandle getParentNativeHandle() const override;
+
+    [[nodiscard]]
+    bool isHelperRunning() const override;
+
+    [[nodiscard]]
+    EmbeddedRemoteStats getStats() const override;
+
+private:
+
+    /////////////////////////////////////////////////////////////////////////////
+    /// SETUP
+    /////////////////////////////////////////////////////////////////////////////
+
+    /////////////////////////////////////////////////////////////////////////////
+    bool createChannel( const sf::Vector2u& size );
+
+    /////////////////////////////////////////////////////////////////////////////
+    bool createWindow( const sf::Vector2u& size );
+
+    /////////////////////////////////////////////////////////////////////////////
+    bool createFrameBitmaps( const sf::Vector2u& size );
+
+    /////////////////////////////////////////////////////////////////////////////
+    bool launchHelper( const std::string& helperPath );
+
+    /////////////////////////////////////////////////////////////////////////////
+    bool registerWaits();
+
+    /////////////////////////////////////////////////////////////////////////////
+    /// PRESENTING AND INPUT
+    /////////////////////////////////////////////////////////////////////////////
+
+    /////////////////////////////////////////////////////////////////////////////
+    void presentLatestFrame();
+
+    /////////////////////////////////////////////////////////////////////////////
+    void blit( HDC hdc ) const;
+
+    /////////////////////////////////////////////////////////////////////////////
+    void forwardInput( UINT msg, WPARAM wParam, LPARAM lParam );
+
+    /////////////////////////////////////////////////////////////////////////////
+    /// WINAPI CALLBACKS
+    /////////////////////////////////////////////////////////////////////////////
+
+    /////////////////////////////////////////////////////////////////////////////
+    static LRESULT WINAPI processWndEvent( HWND hwnd,
+                                           UINT msg,
+                                           WPARAM wParam,
+                                           LPARAM lParam );
+
+    /////////////////////////////////////////////////////////////////////////////
+    static void CALLBACK processFrameSignal( PVOID context, BOOLEAN timedOut );
+
+    /////////////////////////////////////////////////////////////////////////////
+    static void CALLBACK processHelperExit( PVOID context, BOOLEAN timedOut );
+
+private:
+
+    // window messages posted from the thread-pool waits
+    static constexpr UINT WM_PRESENT_FRAME = WM_APP + 1;
+    static constexpr UINT WM_HELPER_EXITED = WM_APP + 2;
+
+    // how long the helper gets to exit on its own before it is terminated
+    static constexpr DWORD HelperExitTimeoutInMS = 1000;
+
+    HWND m_parentHwnd { nullptr };
+    HWND m_childHwnd { nullptr };
+    sf::Vector2u m_size;
+
+    // shared memory and the helper's frame signal
+    std::string m_channelName;
+    HANDLE m_mapping { nullptr };
+    void * m_view { nullptr };
+    std::unique_ptr< EmbeddedRemoteChannel > m_channel;
+    HANDLE m_frameEvent { nullptr };
+
+    // one DIB section per frame of the triple buffer, all backed by the mapping
+    HBITMAP m_frameBitmaps[ 3 ] { nullptr, nullptr, nullptr };
+    HDC m_memoryDc { nullptr };
+
+    // frame of the triple buffer currently owned by the host
+    uint32_t m_frame { 1 };
+    bool m_hasFrame { false };
+
+    // helper process and the waits on it
+    HANDLE m_helperProcess { nullptr };
+    HANDLE m_frameWait { nullptr };
+    HANDLE m_exitWait { nullptr };
+    std::atomic< bool > m_isHelperRunning { false };
+
+    // keeps the frame signal from flooding the message queue
+    std::atomic< bool > m_isPresentPending { false };
+
+    // statistics
+    int64_t m_ticksPerSecond { 1 };
+    uint64_t m_presentedFrames { 0 };
+    uint64_t m_droppedInputs { 0 };
+    int64_t m_lastLatencyTicks { 0 };
+    int64_t m_maxLatencyTicks { 0 };
+    int64_t m_totalLatencyTicks { 0 };
+
+    // one window class shared by all presenters of this module. registered
+    // under a unique name and unregistered with the last one
+    inline static std::string smClassname;
+    inline static std::mutex smClassMutex;
+    inline static uint32_t smClassUsers { 0 };
+
+    // makes every channel name unique within the process
+    inline static std::atomic< uint32_t > smChannelCounter { 0 };
+};
+
+}
@@ -0,0 +1,81 @@
+#include "SFML/Embedded/EmbeddedRemoteRenderer.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+#include "EmbeddedWindowImpl.hpp"
+#include "SFML/Embedded/EmbeddedWindowEventReceiver.hpp"
+#include "SFML/Embedded/EmbeddedLogger.hpp"
+
+#ifdef WIN32
+#include "EmbeddedWindowImplRemoteWin32.hpp"
+using EmbeddedWindowImplRemoteType = sf::priv::EmbeddedWindowImplRemoteWin32;
+#endif
+
+namespace sf
+{
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+std::string EmbeddedRemoteRenderer::findChannelName( int argc, char ** argv )
+{
+  const auto prefixLength = std::strlen( ChannelArgument );
+
+  for ( int i = 1; i < argc; ++i )
+  {
+    if ( argv[ i ] != nullptr && std::strncmp( argv[ i ], ChannelArgument, prefixLength ) == 0 )
+      return argv[ i ] + prefixLength;
+  }
+
+  return {};
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+EmbeddedRemoteRenderer::EmbeddedRemoteRenderer( const std::string& channelName,
+                                                EmbeddedWindowEventReceiver& embeddedWindowEvent,
+                                                const sf::ContextSettings& contextSettings )
+  : m_receiver( embeddedWindowEvent )
+{
+  m_remoteImpl = new EmbeddedWindowImplRemoteType( channelName, { &EmbeddedRemoteRenderer::observe, this } );
+
+  // the helper's window is never shown, so its default framebuffer can't be read back
+  setRenderingOffscreen();
+
+  // the frame size comes from the host, which getParentWindowSize() reports
+  attach( m_remoteImpl, contextSettings, { 0, 0 }, &EmbeddedRemoteRenderer::observe, this );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+EmbeddedRemoteRenderer::~EmbeddedRemoteRenderer()
+{
+  destroy();
+  m_remoteImpl = nullptr;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+int EmbeddedRemoteRenderer::run()
+{
+  if ( m_remoteImpl == nullptr )
+  {
+    LOG_ERROR( "remote renderer was not created" );
+    return EXIT_FAILURE;
+  }
+
+  return m_remoteImpl->runMessageLoop();
+}
+
+////////////////////////////////////////////////////////////
+// STATIC PRIVATE
+void EmbeddedRemoteRenderer::observe( void * context, E_EmbeddedWindowEventState state )
+{
+  auto * self = static_cast< EmbeddedRemoteRenderer * >( context );
+  self->dispatch( self->m_receiver, state );
+
+  if ( state == E_FrameReady && self->bindOffscreenFrame() )
+    static_cast< EmbeddedWindowImplRemoteType * >( self->m_remoteImpl )->publishFrame();
+}
+
+}
@@ -0,0 +1,56 @@
+#include "SFML/Embedded/EmbeddedRemoteWindow.hpp"
+
+#include "EmbeddedRemotePresenter.hpp"
+
+namespace sf
+{
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+EmbeddedRemoteWindow::EmbeddedRemoteWindow( WindowHandle parentHandle,
+                                            const std::string& helperPath,
+                                            const sf::Vector2u& size )
+  : m_impl( priv::EmbeddedRemotePresenter::create( parentHandle, helperPath, size ) )
+{}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+EmbeddedRemoteWindow::~EmbeddedRemoteWindow()
+{
+  delete m_impl;
+  m_impl = nullptr;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+[[nodiscard]]
+WindowHandle EmbeddedRemoteWindow::getSystemHandle() const
+{
+  return m_impl->getNativeHandle();
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+[[nodiscard]]
+WindowHandle EmbeddedRemoteWindow::getParentSystemHandle() const
+{
+  return m_impl->getParentNativeHandle();
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+[[nodiscard]]
+bool EmbeddedRemoteWindow::isHelperRunning() const
+{
+  return m_impl->isHelperRunning();
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+[[nodiscard]]
+EmbeddedRemoteStats EmbeddedRemoteWindow::getStats() const
+{
+  return m_impl->getStats();
+}
+
+}
@@ -0,0 +1,33 @@
+#include "SFML/Embedded/EmbeddedRenderWindow.hpp"
+
+namespace sf::priv
+{
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedRenderWindow::setOffscreenTarget( sf::RenderTexture * target )
+{
+  m_offscreenTarget = target;
+
+  // rebind right away, rather than on the next activation
+  if ( isOpen() )
+    setActive( true );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+bool EmbeddedRenderWindow::setActive( bool active )
+{
+  if ( m_offscreenTarget == nullptr || !active )
+    return sf::RenderWindow::setActive( active );
+
+  // the texture's framebuffer is bound in whichever context is current, so
+  // the window's context goes first. sf::RenderWindow::setActive would
+  // unbind it again. the window then becomes the tracked target once more,
+  // so that its own draws don't activate it over and over
+  return sf::Window::setActive( true ) &&
+         m_offscreenTarget->setActive( true ) &&
+         sf::RenderTarget::setActive( true );
+}
+
+}
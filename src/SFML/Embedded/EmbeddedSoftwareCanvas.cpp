@@ -0,0 +1,376 @@
+#include "SFML/Embedded/EmbeddedSoftwareCanvas.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#define SFML_EMBEDDED_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+
+////////////////////////////////////////////////////////////
+uint32_t toPixel( const sf::Color& color )
+{
+  return 0xFF000000u | ( uint32_t( color.r ) << 16 ) | ( uint32_t( color.g ) << 8 ) | color.b;
+}
+
+////////////////////////////////////////////////////////////
+// ( a * b ) / 255, rounded
+uint32_t multiply( uint32_t a, uint32_t b )
+{
+  const auto product = a * b + 128;
+  return ( product + ( product >> 8 ) ) >> 8;
+}
+
+////////////////////////////////////////////////////////////
+uint32_t blend( uint32_t destination, uint32_t source, uint32_t alpha )
+{
+  const auto inverse = 255 - alpha;
+
+  const auto r = multiply( ( source >> 16 ) & 0xFF, alpha ) + multiply( ( destination >> 16 ) & 0xFF, inverse );
+  const auto g = multiply( ( source >> 8 ) & 0xFF, alpha ) + multiply( ( destination >> 8 ) & 0xFF, inverse );
+  const auto b = multiply( source & 0xFF, alpha ) + multiply( destination & 0xFF, inverse );
+
+  return 0xFF000000u | ( r << 16 ) | ( g << 8 ) | b;
+}
+
+#ifdef SFML_EMBEDDED_SSE2
+
+////////////////////////////////////////////////////////////
+// ( a * b ) / 255 on 16-bit lanes, rounded. both are at most 255
+__m128i multiply( __m128i a, __m128i b )
+{
+  const auto product = _mm_add_epi16( _mm_mullo_epi16( a, b ), _mm_set1_epi16( 128 ) );
+  return _mm_srli_epi16( _mm_add_epi16( product, _mm_srli_epi16( product, 8 ) ), 8 );
+}
+
+////////////////////////////////////////////////////////////
+// blends two pixels, widened to 16-bit lanes
+__m128i blend( __m128i destination, __m128i source, __m128i alpha )
+{
+  const auto inverse = _mm_sub_epi16( _mm_set1_epi16( 255 ), alpha );
+  return _mm_add_epi16( multiply( source, alpha ), multiply( destination, inverse ) );
+}
+
+#endif
+
+////////////////////////////////////////////////////////////
+void fillPixels( uint32_t * destination, int count, uint32_t pixel )
+{
+  int i = 0;
+
+#ifdef SFML_EMBEDDED_SSE2
+  const auto pixels = _mm_set1_epi32( static_cast< int >( pixel ) );
+  for ( ; i + 4 <= count; i += 4 )
+    _mm_storeu_si128( reinterpret_cast< __m128i * >( destination + i ), pixels );
+#endif
+
+  for ( ; i < count; ++i )
+    destination[ i ] = pixel;
+}
+
+////////////////////////////////////////////////////////////
+void blendPixels( uint32_t * destination, int count, uint32_t pixel, uint32_t alpha )
+{
+  int i = 0;
+
+#ifdef SFML_EMBEDDED_SSE2
+  const auto zero = _mm_setzero_si128();
+  const auto source = _mm_unpacklo_epi8( _mm_set1_epi32( static_cast< int >( pixel ) ), zero );
+  const auto alphas = _mm_set1_epi16( static_cast< short >( alpha ) );
+  const auto opaque = _mm_set1_epi32( static_cast< int >( 0xFF000000u ) );
+
+  for ( ; i + 4 <= count; i += 4 )
+  {
+    auto * address = reinterpret_cast< __m128i * >( destination + i );
+    const auto pixels = _mm_loadu_si128( address );
+
+    const auto low = blend( _mm_unpacklo_epi8( pixels, zero ), source, alphas );
+    const auto high = blend( _mm_unpackhi_epi8( pixels, zero ), source, alphas );
+
+    _mm_storeu_si128( address, _mm_or_si128( _mm_packus_epi16( low, high ), opaque ) );
+  }
+#endif
+
+  for ( ; i < count; ++i )
+    destination[ i ] = blend( destination[ i ], pixel, alpha );
+}
+
+////////////////////////////////////////////////////////////
+// source is RGBA, as sf::Image stores it
+void blendImagePixels( uint32_t * destination, const uint8_t * source, int count )
+{
+  int i = 0;
+
+#ifdef SFML_EMBEDDED_SSE2
+  const auto zero = _mm_setzero_si128();
+  const auto redBlue = _mm_set1_epi32( 0x00FF00FF );
+  const auto opaque = _mm_set1_epi32( static_cast< int >( 0xFF000000u ) );
+
+  for ( ; i + 4 <= count; i += 4 )
+  {
+    auto rgba = _mm_loadu_si128( reinterpret_cast< const __m128i * >( source + i * 4 ) );
+
+    // all four transparent or all four opaque are the common cases in UI art
+    const auto alphaMask = _mm_movemask_epi8( _mm_cmpeq_epi8( _mm_srli_epi32( rgba, 24 ), zero ) );
+    if ( alphaMask == 0xFFFF )
+      continue;
+
+    // RGBA to BGRA: swap the bytes that hold red and blue
+    const auto swapped = _mm_and_si128( _mm_or_si128( _mm_srli_epi32( rgba, 16 ), _mm_slli_epi32( rgba, 16 ) ), redBlue );
+    rgba = _mm_or_si128( _mm_andnot_si128( redBlue, rgba ), swapped );
+
+    auto * address = reinterpret_cast< __m128i * >( destination + i );
+    const auto isOpaque = _mm_movemask_epi8( _mm_cmpeq_epi32( _mm_and_si128( rgba, opaque ), opaque ) ) == 0xFFFF;
+    if ( isOpaque )
+    {
+      _mm_storeu_si128( address, rgba );
+      continue;
+    }
+
+    const auto pixels = _mm_loadu_si128( address );
+
+    // spread each pixel's alpha over its four lanes
+    const auto sourceLow = _mm_unpacklo_epi8( rgba, zero );
+    const auto sourceHigh = _mm_unpackhi_epi8( rgba, zero );
+    const auto alphaLow = _mm_shufflehi_epi16( _mm_shufflelo_epi16( sourceLow, _MM_SHUFFLE( 3, 3, 3, 3 ) ), _MM_SHUFFLE( 3, 3, 3, 3 ) );
+    const auto alphaHigh = _mm_shufflehi_epi16( _mm_shufflelo_epi16( sourceHigh, _MM_SHUFFLE( 3, 3, 3, 3 ) ), _MM_SHUFFLE( 3, 3, 3, 3 ) );
+
+    const auto low = blend( _mm_unpacklo_epi8( pixels, zero ), sourceLow, alphaLow );
+    const auto high = blend( _mm_unpackhi_epi8( pixels, zero ), sourceHigh, alphaHigh );
+
+    _mm_storeu_si128( address, _mm_or_si128( _mm_packus_epi16( low, high ), opaque ) );
+  }
+#endif
+
+  for ( ; i < count; ++i )
+  {
+    const auto * rgba = source + i * 4;
+    const auto pixel = ( uint32_t( rgba[ 0 ] ) << 16 ) | ( uint32_t( rgba[ 1 ] ) << 8 ) | rgba[ 2 ];
+
+    if ( rgba[ 3 ] == 255 )
+      destination[ i ] = 0xFF000000u | pixel;
+    else if ( rgba[ 3 ] != 0 )
+      destination[ i ] = blend( destination[ i ], pixel, rgba[ 3 ] );
+  }
+}
+
+}
+
+namespace sf
+{
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+EmbeddedSoftwareCanvas::EmbeddedSoftwareCanvas( uint32_t * pixels, const sf::Vector2u& size, uint32_t stride )
+  : m_pixels( pixels ),
+    m_size( size ),
+    m_stride( stride )
+{
+  resetClip();
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedSoftwareCanvas::setClip( const sf::IntRect& clip )
+{
+  const auto left = std::max( clip.left, 0 );
+  const auto top = std::max( clip.top, 0 );
+  const auto right = std::min( clip.left + clip.width, static_cast< int >( m_size.x ) );
+  const auto bottom = std::min( clip.top + clip.height, static_cast< int >( m_size.y ) );
+
+  m_clip = { left, top, std::max( 0, right - left ), std::max( 0, bottom - top ) };
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedSoftwareCanvas::resetClip()
+{
+  m_clip = { 0, 0, static_cast< int >( m_size.x ), static_cast< int >( m_size.y ) };
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedSoftwareCanvas::clear( const sf::Color& color )
+{
+  const auto pixel = toPixel( color );
+
+  for ( int y = m_clip.top; y < m_clip.top + m_clip.height; ++y )
+    fillPixels( m_pixels + std::size_t( y ) * m_stride + m_clip.left, m_clip.width, pixel );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedSoftwareCanvas::fillRect( const sf::IntRect& rect, const sf::Color& color )
+{
+  if ( color.a == 0 )
+    return;
+
+  const auto top = std::max( rect.top, m_clip.top );
+  const auto bottom = std::min( rect.top + rect.height, m_clip.top + m_clip.height );
+
+  for ( int y = top; y < bottom; ++y )
+    fillSpan( y, rect.left, rect.left + rect.width, color );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedSoftwareCanvas::drawRect( const sf::IntRect& rect, const sf::Color& color, int thickness )
+{
+  // clamped, so that thick outlines of small rectangles don't overlap themselves
+  const auto horizontal = std::min( thickness, ( rect.height + 1 ) / 2 );
+  const auto vertical = std::min( thickness, ( rect.width + 1 ) / 2 );
+
+  fillRect( { rect.left, rect.top, rect.width, horizontal }, color );
+  fillRect( { rect.left, rect.top + rect.height - horizontal, rect.width, horizontal }, color );
+  fillRect( { rect.left, rect.top + horizontal, vertical, rect.height - 2 * horizontal }, color );
+  fillRect( { rect.left + rect.width - vertical, rect.top + horizontal, vertical, rect.height - 2 * horizontal }, color );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedSoftwareCanvas::fillCircle( const sf::Vector2f& center, float radius, const sf::Color& color )
+{
+  if ( color.a == 0 || radius <= 0.f )
+    return;
+
+  const auto top = std::max( static_cast< int >( std::floor( center.y - radius ) ), m_clip.top );
+  const auto bottom = std::min( static_cast< int >( std::ceil( center.y + radius ) ), m_clip.top + m_clip.height );
+
+  // pixel centers inside the circle
+  for ( int y = top; y < bottom; ++y )
+  {
+    const auto dy = static_cast< float >( y ) + 0.5f - center.y;
+    const auto halfWidthSquared = radius * radius - dy * dy;
+    if ( halfWidthSquared <= 0.f )
+      continue;
+
+    const auto halfWidth = std::sqrt( halfWidthSquared );
+    fillSpan( y,
+              static_cast< int >( std::ceil( center.x - halfWidth - 0.5f ) ),
+              static_cast< int >( std::ceil( center.x + halfWidth - 0.5f ) ),
+              color );
+  }
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedSoftwareCanvas::fillConvexPolygon( const sf::Vector2f * points, std::size_t count, const sf::Color& color )
+{
+  if ( color.a == 0 || count < 3 )
+    return;
+
+  auto minY = points[ 0 ].y;
+  auto maxY = points[ 0 ].y;
+  for ( std::size_t i = 1; i < count; ++i )
+  {
+    minY = std::min( minY, points[ i ].y );
+    maxY = std::max( maxY, points[ i ].y );
+  }
+
+  const auto top = std::max( static_cast< int >( std::floor( minY ) ), m_clip.top );
+  const auto bottom = std::min( static_cast< int >( std::ceil( maxY ) ), m_clip.top + m_clip.height );
+
+  // a convex polygon crosses each row at most twice: the span between the
+  // leftmost and the rightmost crossing of the row's pixel centers
+  for ( int y = top; y < bottom; ++y )
+  {
+    const auto centerY = static_cast< float >( y ) + 0.5f;
+    auto left = static_cast< float >( m_clip.left + m_clip.width );
+    auto right = static_cast< float >( m_clip.left );
+
+    for ( std::size_t i = 0; i < count; ++i )
+    {
+      const auto& a = points[ i ];
+      const auto& b = points[ ( i + 1 ) % count ];
+
+      // half-open, so that a vertex on the row is counted once
+      if ( ( a.y <= centerY ) == ( b.y <= centerY ) )
+        continue;
+
+      const auto x = a.x + ( centerY - a.y ) * ( b.x - a.x ) / ( b.y - a.y );
+      left = std::min( left, x );
+      right = std::max( right, x );
+    }
+
+    if ( left < right )
+      fillSpan( y, static_cast< int >( std::ceil( left - 0.5f ) ), static_cast< int >( std::ceil( right - 0.5f ) ), color );
+  }
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedSoftwareCanvas::drawLine( const sf::Vector2f& from, const sf::Vector2f& to, float thickness, const sf::Color& color )
+{
+  const sf::Vector2f direction = to - from;
+  const auto length = std::sqrt( direction.x * direction.x + direction.y * direction.y );
+  if ( length <= 0.f )
+    return;
+
+  // half the thickness on either side of the line
+  const sf::Vector2f normal( -direction.y / length * thickness * 0.5f, direction.x / length * thickness * 0.5f );
+  const sf::Vector2f quad[] = { from + normal, to + normal, to - normal, from - normal };
+
+  fillConvexPolygon( quad, 4, color );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedSoftwareCanvas::drawImage( const sf::Image& image, const sf::Vector2i& position )
+{
+  const auto size = image.getSize();
+  drawImage( image, position, { 0, 0, static_cast< int >( size.x ), static_cast< int >( size.y ) } );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedSoftwareCanvas::drawImage( const sf::Image& image, const sf::Vector2i& position, const sf::IntRect& sourceRect )
+{
+  const auto * source = image.getPixelsPtr();
+  const auto imageSize = image.getSize();
+  if ( source == nullptr )
+    return;
+
+  // clip the source to the image, then the destination to the clip
+  auto left = std::max( sourceRect.left, 0 );
+  auto top = std::max( sourceRect.top, 0 );
+  auto right = std::min( sourceRect.left + sourceRect.width, static_cast< int >( imageSize.x ) );
+  auto bottom = std::min( sourceRect.top + sourceRect.height, static_cast< int >( imageSize.y ) );
+
+  const auto offsetX = position.x - sourceRect.left;
+  const auto offsetY = position.y - sourceRect.top;
+
+  left = std::max( left, m_clip.left - offsetX );
+  top = std::max( top, m_clip.top - offsetY );
+  right = std::min( right, m_clip.left + m_clip.width - offsetX );
+  bottom = std::min( bottom, m_clip.top + m_clip.height - offsetY );
+
+  for ( int y = top; y < bottom; ++y )
+  {
+    blendImagePixels( m_pixels + std::size_t( y + offsetY ) * m_stride + ( left + offsetX ),
+                      source + ( std::size_t( y ) * imageSize.x + left ) * 4,
+                      right - left );
+  }
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+void EmbeddedSoftwareCanvas::fillSpan( int y, int left, int right, const sf::Color& color )
+{
+  left = std::max( left, m_clip.left );
+  right = std::min( right, m_clip.left + m_clip.width );
+  if ( left >= right )
+    return;
+
+  auto * row = m_pixels + std::size_t( y ) * m_stride + left;
+
+  if ( color.a == 255 )
+    fillPixels( row, right - left, toPixel( color ) );
+  else
+    blendPixels( row, right - left, toPixel( color ), color.a );
+}
+
+}
@@ -0,0 +1,115 @@
+#include "SFML/Embedded/EmbeddedTaskQueue.hpp"
+
+#include <SFML/System/Clock.hpp>
+
+namespace sf
+{
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+EmbeddedTaskQueue::EmbeddedTaskQueue( std::size_t capacity )
+{
+  std::size_t powerOf2 = 2;
+  while ( powerOf2 < capacity )
+    powerOf2 <<= 1;
+
+  m_nodes = std::make_unique< Node[] >( powerOf2 );
+  m_mask = powerOf2 - 1;
+
+  // each node starts out as free for the producer at the same position
+  for ( std::size_t i = 0; i < powerOf2; ++i )
+    m_nodes[ i ].sequence.store( i, std::memory_order_relaxed );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+EmbeddedTaskQueue::~EmbeddedTaskQueue()
+{
+  // destroy, but do not run, anything still queued
+  for ( ;; )
+  {
+    Node& node = m_nodes[ m_dequeuePosition & m_mask ];
+    if ( node.sequence.load( std::memory_order_acquire ) != m_dequeuePosition + 1 )
+      break;
+
+    node.destroy( node.storage );
+    ++m_dequeuePosition;
+  }
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+std::size_t EmbeddedTaskQueue::drain( sf::Time budget, std::size_t maxTasks )
+{
+  sf::Clock clock;
+  std::size_t count = 0;
+
+  while ( count < maxTasks )
+  {
+    Node& node = m_nodes[ m_dequeuePosition & m_mask ];
+
+    // the producer has not published this node yet (or the queue is empty)
+    if ( node.sequence.load( std::memory_order_acquire ) != m_dequeuePosition + 1 )
+      break;
+
+    // hands the node back to the producers for the next lap, even if the
+    // task throws. otherwise the queue would stall on it from then on
+    struct NodeRelease
+    {
+      EmbeddedTaskQueue& queue;
+      Node& node;
+
+      ~NodeRelease()
+      {
+        node.destroy( node.storage );
+        node.sequence.store( queue.m_dequeuePosition + queue.m_mask + 1, std::memory_order_release );
+        ++queue.m_dequeuePosition;
+      }
+    };
+
+    {
+      NodeRelease release { *this, node };
+      node.invoke( node.storage );
+    }
+
+    ++count;
+
+    if ( clock.getElapsedTime() >= budget )
+      break;
+  }
+
+  return count;
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+EmbeddedTaskQueue::Node * EmbeddedTaskQueue::reserve( std::size_t& position )
+{
+  position = m_enqueuePosition.load( std::memory_order_relaxed );
+
+  for ( ;; )
+  {
+    Node& node = m_nodes[ position & m_mask ];
+    const auto sequence = node.sequence.load( std::memory_order_acquire );
+    const auto diff = static_cast< std::intptr_t >( sequence ) - static_cast< std::intptr_t >( position );
+
+    if ( diff == 0 )
+    {
+      // the node is free. try to claim it
+      if ( m_enqueuePosition.compare_exchange_weak( position, position + 1, std::memory_order_relaxed ) )
+        return &node;
+    }
+    else if ( diff < 0 )
+    {
+      // the consumer has not released this node yet, i.e., the queue is full
+      return nullptr;
+    }
+    else
+    {
+      // another producer claimed it first
+      position = m_enqueuePosition.load( std::memory_order_relaxed );
+    }
+  }
+}
+
+}
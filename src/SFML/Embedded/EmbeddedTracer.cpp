@@ -0,0 +1,357 @@
+#include "SFML/Embedded/EmbeddedTracer.hpp"
+
+#ifdef SFML_EMBEDDED_TRACING
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "SFML/Embedded/EmbeddedLogger.hpp"
+
+namespace
+{
+
+static_assert( ( sf::EmbeddedTracer::EventsPerThread & ( sf::EmbeddedTracer::EventsPerThread - 1 ) ) == 0,
+               "EventsPerThread must be a power of 2" );
+
+// duration of an instant event
+constexpr int64_t InstantDuration = -1;
+
+// the fields are relaxed atomics so that a dump can read a ring while its
+// thread keeps writing. on the platforms we support these are plain moves
+struct TraceEvent
+{
+  std::atomic< const char * > name { nullptr };
+  std::atomic< int64_t > start { 0 };
+  std::atomic< int64_t > duration { 0 };
+};
+
+struct TraceThread
+{
+  uint32_t id { 0 };
+  std::atomic< const char * > name { nullptr };
+
+  // total number of events ever written. only the owning thread stores it
+  std::atomic< uint64_t > written { 0 };
+
+  // events before this index were cleared
+  std::atomic< uint64_t > cleared { 0 };
+
+  // set once the owning thread has exited. guarded by the registry's mutex
+  bool isExited { false };
+
+  std::unique_ptr< TraceEvent[] > events { new TraceEvent[ sf::EmbeddedTracer::EventsPerThread ] };
+};
+
+struct TraceRegistry
+{
+  std::mutex mutex;
+
+  // the rings of exited threads are kept so that their events can still be
+  // dumped, until a new thread takes them over or clear() frees them
+  std::vector< std::unique_ptr< TraceThread > > threads;
+  uint32_t nextId { 0 };
+};
+
+// the calling thread's ring. a thread that never records an event never gets one
+struct ThreadSlot
+{
+  TraceThread * thread { nullptr };
+
+  // set by setThreadName, possibly before there is a ring to name
+  const char * name { nullptr };
+
+  ~ThreadSlot();
+};
+
+////////////////////////////////////////////////////////////
+TraceRegistry& getRegistry()
+{
+  static TraceRegistry registry;
+  return registry;
+}
+
+////////////////////////////////////////////////////////////
+ThreadSlot::~ThreadSlot()
+{
+  if ( thread == nullptr )
+    return;
+
+  auto& registry = getRegistry();
+  std::unique_lock< std::mutex > lock( registry.mutex );
+  thread->isExited = true;
+}
+
+////////////////////////////////////////////////////////////
+ThreadSlot& getSlot()
+{
+  thread_local ThreadSlot slot;
+  return slot;
+}
+
+////////////////////////////////////////////////////////////
+TraceThread& getThread()
+{
+  auto& slot = getSlot();
+
+  if ( slot.thread == nullptr )
+  {
+    auto& registry = getRegistry();
+    std::unique_lock< std::mutex > lock( registry.mutex );
+
+    // take over the ring of a thread that has exited, so that threads which
+    // come and go (asset workers, frame threads) don't add a ring each time
+    auto it = std::find_if( registry.threads.begin(),
+                            registry.threads.end(),
+                            []( const auto& thread ) { return thread->isExited; } );
+
+    if ( it == registry.threads.end() )
+    {
+      registry.threads.push_back( std::make_unique< TraceThread >() );
+      it = registry.threads.end() - 1;
+    }
+
+    auto& thread = **it;
+    thread.id = ++registry.nextId;
+    thread.name.store( slot.name, std::memory_order_relaxed );
+    thread.written.store( 0, std::memory_order_relaxed );
+    thread.cleared.store( 0, std::memory_order_relaxed );
+    thread.isExited = false;
+
+    slot.thread = &thread;
+  }
+
+  return *slot.thread;
+}
+
+////////////////////////////////////////////////////////////
+void record( const char * name, int64_t start, int64_t duration )
+{
+  auto& thread = getThread();
+  const auto index = thread.written.load( std::memory_order_relaxed );
+  auto& event = thread.events[ index & ( sf::EmbeddedTracer::EventsPerThread - 1 ) ];
+
+  event.name.store( name, std::memory_order_relaxed );
+  event.start.store( start, std::memory_order_relaxed );
+  event.duration.store( duration, std::memory_order_relaxed );
+
+  thread.written.store( index + 1, std::memory_order_release );
+}
+
+////////////////////////////////////////////////////////////
+void appendEscaped( std::string& json, const char * text )
+{
+  for ( ; *text != '\0'; ++text )
+  {
+    if ( *text == '"' || *text == '\\' )
+      json += '\\';
+
+    // control characters would break the JSON. they don't belong in a name anyway
+    json += static_cast< unsigned char >( *text ) < 0x20 ? ' ' : *text;
+  }
+}
+
+////////////////////////////////////////////////////////////
+// chrome expects microseconds. keep the nanoseconds as decimals
+void appendMicroseconds( std::string& json, int64_t nanoseconds )
+{
+  char buffer[ 32 ];
+  std::snprintf( buffer,
+                 sizeof( buffer ),
+                 "%" PRId64 ".%03d",
+                 nanoseconds / 1000,
+                 static_cast< int >( nanoseconds % 1000 ) );
+  json += buffer;
+}
+
+}
+
+namespace sf
+{
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedTracer::setEnabled( bool enabled )
+{
+  smEnabled.store( enabled, std::memory_order_relaxed );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedTracer::setThreadName( const char * name )
+{
+  // the ring is only allocated with the thread's first event
+  auto& slot = getSlot();
+  slot.name = name;
+
+  if ( slot.thread != nullptr )
+    slot.thread->name.store( name, std::memory_order_relaxed );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedTracer::instant( const char * name )
+{
+  record( name, now(), InstantDuration );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedTracer::complete( const char * name, int64_t start, int64_t end )
+{
+  record( name, start, std::max< int64_t >( 0, end - start ) );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+std::string EmbeddedTracer::getChromeTrace()
+{
+  struct Event
+  {
+    const char * name;
+    int64_t start;
+    int64_t duration;
+    uint32_t thread;
+  };
+
+  std::vector< Event > events;
+  std::vector< std::pair< uint32_t, const char * > > threadNames;
+
+  {
+    auto& registry = getRegistry();
+    std::unique_lock< std::mutex > lock( registry.mutex );
+
+    for ( const auto& thread : registry.threads )
+    {
+      if ( const auto * name = thread->name.load( std::memory_order_relaxed ) )
+        threadNames.emplace_back( thread->id, name );
+
+      const auto written = thread->written.load( std::memory_order_acquire );
+      auto first = std::max( thread->cleared.load( std::memory_order_relaxed ),
+                             written > EventsPerThread ? written - EventsPerThread : 0 );
+
+      const auto copied = events.size();
+      for ( auto index = first; index < written; ++index )
+      {
+        const auto& event = thread->events[ index & ( EventsPerThread - 1 ) ];
+        events.push_back( { event.name.load( std::memory_order_relaxed ),
+                            event.start.load( std::memory_order_relaxed ),
+                            event.duration.load( std::memory_order_relaxed ),
+                            thread->id } );
+      }
+
+      // the thread kept recording while we copied. drop every slot it may
+      // have overwritten in the meantime, including the one it may be writing
+      const auto after = thread->written.load( std::memory_order_acquire );
+      if ( after + 1 > first + EventsPerThread )
+      {
+        const auto overwritten = std::min< uint64_t >( after + 1 - EventsPerThread - first, written - first );
+        events.erase( events.begin() + static_cast< std::ptrdiff_t >( copied ),
+                      events.begin() + static_cast< std::ptrdiff_t >( copied + overwritten ) );
+      }
+    }
+  }
+
+  // timestamps start at the first event so that they stay readable
+  auto origin = std::numeric_limits< int64_t >::max();
+  for ( const auto& event : events )
+    origin = std::min( origin, event.start );
+
+  std::string json;
+  json.reserve( 128 + events.size() * 96 );
+  json += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+  bool first = true;
+  const auto separate = [ &json, &first ]()
+  {
+    if ( !first )
+      json += ',';
+
+    json += '\n';
+    first = false;
+  };
+
+  for ( const auto& [ id, name ] : threadNames )
+  {
+    separate();
+    json += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":";
+    json += std::to_string( id );
+    json += ",\"args\":{\"name\":\"";
+    appendEscaped( json, name );
+    json += "\"}}";
+  }
+
+  for ( const auto& event : events )
+  {
+    if ( event.name == nullptr )
+      continue;
+
+    separate();
+    json += "{\"name\":\"";
+    appendEscaped( json, event.name );
+    json += event.duration == InstantDuration ? "\",\"ph\":\"i\",\"s\":\"t\"" : "\",\"ph\":\"X\"";
+    json += ",\"pid\":1,\"tid\":";
+    json += std::to_string( event.thread );
+    json += ",\"ts\":";
+    appendMicroseconds( json, event.start - origin );
+
+    if ( event.duration != InstantDuration )
+    {
+      json += ",\"dur\":";
+      appendMicroseconds( json, event.duration );
+    }
+
+    json += '}';
+  }
+
+  json += "\n]}\n";
+  return json;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+bool EmbeddedTracer::writeChromeTrace( const std::string& filename )
+{
+  std::ofstream file( filename, std::ios::binary | std::ios::trunc );
+  if ( !file )
+  {
+    LOG_ERROR( "unable to open trace file {}", filename );
+    return false;
+  }
+
+  file << getChromeTrace();
+  if ( !file )
+  {
+    LOG_ERROR( "unable to write trace file {}", filename );
+    return false;
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedTracer::clear()
+{
+  auto& registry = getRegistry();
+  std::unique_lock< std::mutex > lock( registry.mutex );
+
+  // nothing is left to dump from the rings of exited threads
+  registry.threads.erase( std::remove_if( registry.threads.begin(),
+                                          registry.threads.end(),
+                                          []( const auto& thread ) { return thread->isExited; } ),
+                          registry.threads.end() );
+
+  // the other rings belong to their threads, so only move the start of each one
+  for ( auto& thread : registry.threads )
+    thread->cleared.store( thread->written.load( std::memory_order_acquire ), std::memory_order_relaxed );
+}
+
+}
+
+#endif
@@ -0,0 +1,557 @@
+#include "SFML/Embedded/EmbeddedViewportCompositor.hpp"
+#include "SFML/Embedded/EmbeddedLogger.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
+#include <SFML/Graphics/RenderWindow.hpp>
+#include <SFML/Graphics/Sprite.hpp>
+
+namespace sf
+{
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedViewport::setArea( const sf::FloatRect& area )
+{
+  m_area = area;
+  m_isInvalidated = true;
+
+  // otherwise it is laid out when it is created
+  if ( m_isCreated )
+    m_compositor.layoutViewport( *this );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedViewport::setView( const sf::View& view )
+{
+  // the compositor places the viewport, so the view always fills the texture
+  m_view = view;
+  m_view.setViewport( { 0.f, 0.f, 1.f, 1.f } );
+  m_hasCustomView = true;
+  m_isInvalidated = true;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedViewport::setClearColor( const sf::Color& color )
+{
+  m_clearColor = color;
+  m_isInvalidated = true;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+[[nodiscard]]
+sf::Vector2f EmbeddedViewport::mapPixelToCoords( const sf::Vector2i& point ) const
+{
+  if ( !m_texture )
+    return { static_cast< float >( point.x ), static_cast< float >( point.y ) };
+
+  return m_texture->mapPixelToCoords( point, m_view );
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+EmbeddedViewport::EmbeddedViewport( EmbeddedViewportCompositor& compositor,
+                                    EmbeddedViewportReceiver& receiver,
+                                    const sf::FloatRect& area )
+  : m_compositor( compositor ),
+    m_receiver( receiver ),
+    m_area( area )
+{}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+bool EmbeddedViewport::layout( const sf::Vector2u& windowSize )
+{
+  // round the edges rather than the sizes so that adjacent viewports never
+  // leave a gap or overlap between them
+  const auto toPixel = []( float ratio, unsigned int size )
+  {
+    return static_cast< int >( std::lround( ratio * static_cast< float >( size ) ) );
+  };
+
+  const int left = toPixel( m_area.left, windowSize.x );
+  const int top = toPixel( m_area.top, windowSize.y );
+  const int width = std::max( 1, toPixel( m_area.left + m_area.width, windowSize.x ) - left );
+  const int height = std::max( 1, toPixel( m_area.top + m_area.height, windowSize.y ) - top );
+
+  const bool isResized = !m_isCreated || width != m_pixelArea.width || height != m_pixelArea.height;
+  m_pixelArea = { left, top, width, height };
+
+  if ( isResized )
+  {
+    if ( !m_texture )
+      m_texture = std::make_unique< sf::RenderTexture >();
+
+    if ( !m_texture->create( static_cast< unsigned int >( width ), static_cast< unsigned int >( height ) ) )
+    {
+      LOG_ERROR( "failed to create a {}x{} viewport", width, height );
+      release();
+      return false;
+    }
+
+    m_textureCharge.setBytes( static_cast< uint64_t >( width ) * static_cast< uint64_t >( height ) * 4 );
+
+    // without a view of its own, the viewport is drawn in its own pixels
+    if ( !m_hasCustomView )
+      m_view.reset( { 0.f, 0.f, static_cast< float >( width ), static_cast< float >( height ) } );
+  }
+
+  m_isInvalidated = true;
+  return true;
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+void EmbeddedViewport::redraw()
+{
+  m_texture->setView( m_view );
+  m_texture->clear( m_clearColor );
+  m_receiver.onDraw( *this, *m_texture );
+  m_texture->display();
+
+  m_isInvalidated = false;
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+void EmbeddedViewport::release()
+{
+  m_isCreated = false;
+  m_texture.reset();
+  m_textureCharge.setBytes( 0 );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+EmbeddedViewportCompositor::~EmbeddedViewportCompositor() = default;
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+EmbeddedViewport& EmbeddedViewportCompositor::addViewport( EmbeddedViewportReceiver& receiver,
+                                                           const sf::FloatRect& area )
+{
+  m_viewports.push_back( std::unique_ptr< EmbeddedViewport >( new EmbeddedViewport( *this, receiver, area ) ) );
+  auto& viewport = *m_viewports.back();
+
+  // otherwise it is created along with the window
+  if ( m_embeddedWindow != nullptr )
+    createViewport( viewport );
+
+  m_needsComposite = true;
+  return viewport;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedViewportCompositor::removeViewport( EmbeddedViewport& viewport )
+{
+  if ( viewport.m_isRemoved )
+    return;
+
+  if ( viewport.m_isCreated && m_embeddedWindow != nullptr )
+    viewport.m_receiver.onViewportDestroyed( *m_embeddedWindow, viewport );
+
+  viewport.m_isRemoved = true;
+  viewport.release();
+  forget( viewport );
+
+  m_hasRemoved = true;
+  m_needsComposite = true;
+
+  if ( !m_isInFrame )
+    eraseRemoved();
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+[[nodiscard]]
+EmbeddedViewport * EmbeddedViewportCompositor::findViewport( const sf::Vector2i& point ) const
+{
+  // topmost first
+  for ( auto it = m_viewports.rbegin(); it != m_viewports.rend(); ++it )
+  {
+    auto& viewport = **it;
+    if ( viewport.m_isCreated && viewport.m_pixelArea.contains( point ) )
+      return &viewport;
+  }
+
+  return nullptr;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedViewportCompositor::setBackgroundColor( const sf::Color& color )
+{
+  m_backgroundColor = color;
+  m_needsComposite = true;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedViewportCompositor::invalidateAll()
+{
+  for ( auto& viewport : m_viewports )
+    viewport->invalidate();
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedViewportCompositor::onWindowCreated( const EmbeddedWindow& embeddedWindow, RenderWindow& window )
+{
+  m_embeddedWindow = &embeddedWindow;
+  m_windowSize = window.getSize();
+  m_needsComposite = true;
+
+  for ( std::size_t i = 0; i < m_viewports.size(); ++i )
+  {
+    if ( !m_viewports[ i ]->m_isRemoved )
+      createViewport( *m_viewports[ i ] );
+  }
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedViewportCompositor::onWindowDestroyed( const EmbeddedWindow& embeddedWindow, RenderWindow& window )
+{
+  std::ignore = window;
+
+  for ( auto& viewport : m_viewports )
+  {
+    if ( viewport->m_isCreated )
+      viewport->m_receiver.onViewportDestroyed( embeddedWindow, *viewport );
+
+    // the textures belong to the window's context, which goes with it
+    viewport->release();
+  }
+
+  m_focused = nullptr;
+  m_hovered = nullptr;
+  m_captured = nullptr;
+  m_capturedButtons = 0;
+  m_embeddedWindow = nullptr;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedViewportCompositor::onError()
+{
+  LOG_ERROR( "the window hosting the viewports could not be created" );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedViewportCompositor::onFrame( const EmbeddedWindow& embeddedWindow, RenderWindow& window )
+{
+  m_embeddedWindow = &embeddedWindow;
+  m_isInFrame = true;
+
+  sf::Event event {};
+  while ( window.pollEvent( event ) )
+  {
+    if ( event.type == sf::Event::Resized )
+      layout( { event.size.width, event.size.height } );
+    else
+      route( event );
+  }
+
+  // by index: receivers may add viewports from their callbacks
+  for ( std::size_t i = 0; i < m_viewports.size(); ++i )
+  {
+    auto& viewport = *m_viewports[ i ];
+    if ( viewport.m_isCreated )
+      viewport.m_receiver.onUpdate( embeddedWindow, viewport );
+  }
+
+  bool isRedrawn = false;
+  for ( std::size_t i = 0; i < m_viewports.size(); ++i )
+  {
+    auto& viewport = *m_viewports[ i ];
+    if ( viewport.m_isCreated && viewport.m_isInvalidated )
+    {
+      viewport.redraw();
+      isRedrawn = true;
+    }
+  }
+
+  m_isInFrame = false;
+  eraseRemoved();
+
+  // nothing changed: keep what's on screen and skip the swap altogether
+  if ( !isRedrawn && !m_needsComposite )
+  {
+    embeddedWindow.keepLastFrame();
+    return;
+  }
+
+  // the back buffer is undefined after a swap, so every viewport is blitted
+  // again. they are cached textures, so that is one quad each
+  window.setView( sf::View( { 0.f, 0.f, static_cast< float >( m_windowSize.x ), static_cast< float >( m_windowSize.y ) } ) );
+  window.clear( m_backgroundColor );
+
+  sf::Sprite sprite;
+  for ( auto& viewport : m_viewports )
+  {
+    if ( !viewport->m_isCreated )
+      continue;
+
+    sprite.setTexture( viewport->m_texture->getTexture(), true );
+    sprite.setPosition( static_cast< float >( viewport->m_pixelArea.left ),
+                        static_cast< float >( viewport->m_pixelArea.top ) );
+    window.draw( sprite );
+  }
+
+  window.display();
+  m_needsComposite = false;
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+void EmbeddedViewportCompositor::route( const sf::Event& event )
+{
+  switch ( event.type )
+  {
+    case sf::Event::MouseMoved:
+    {
+      const sf::Vector2i point { event.mouseMove.x, event.mouseMove.y };
+      auto * hit = findViewport( point );
+
+      // hover follows the cursor unless a button is held down
+      if ( m_captured == nullptr && hit != m_hovered )
+      {
+        sf::Event crossing {};
+        crossing.type = sf::Event::MouseLeft;
+        if ( m_hovered != nullptr )
+          m_hovered->m_receiver.onEvent( *m_hovered, crossing );
+
+        m_hovered = hit;
+
+        crossing.type = sf::Event::MouseEntered;
+        if ( m_hovered != nullptr )
+          m_hovered->m_receiver.onEvent( *m_hovered, crossing );
+      }
+
+      routeMouse( m_captured != nullptr ? m_captured : hit, event );
+      break;
+    }
+
+    case sf::Event::MouseButtonPressed:
+    {
+      auto * hit = m_captured != nullptr
+                   ? m_captured
+                   : findViewport( { event.mouseButton.x, event.mouseButton.y } );
+
+      // clicking a viewport gives it the keyboard
+      if ( hit != m_focused )
+      {
+        sf::Event focus {};
+        focus.type = sf::Event::LostFocus;
+        if ( m_focused != nullptr )
+          m_focused->m_receiver.onEvent( *m_focused, focus );
+
+        m_focused = hit;
+
+        focus.type = sf::Event::GainedFocus;
+        if ( m_focused != nullptr )
+          m_focused->m_receiver.onEvent( *m_focused, focus );
+      }
+
+      // drags stay with the viewport they started in
+      if ( hit != nullptr )
+      {
+        m_captured = hit;
+        ++m_capturedButtons;
+      }
+
+      routeMouse( hit, event );
+      break;
+    }
+
+    case sf::Event::MouseButtonReleased:
+    {
+      auto * target = m_captured != nullptr
+                      ? m_captured
+                      : findViewport( { event.mouseButton.x, event.mouseButton.y } );
+
+      if ( m_captured != nullptr && --m_capturedButtons <= 0 )
+      {
+        m_captured = nullptr;
+        m_capturedButtons = 0;
+      }
+
+      routeMouse( target, event );
+      break;
+    }
+
+    case sf::Event::MouseWheelScrolled:
+      routeMouse( m_captured != nullptr
+                  ? m_captured
+                  : findViewport( { event.mouseWheelScroll.x, event.mouseWheelScroll.y } ),
+                  event );
+      break;
+
+    case sf::Event::MouseWheelMoved:
+      routeMouse( m_captured != nullptr
+                  ? m_captured
+                  : findViewport( { event.mouseWheel.x, event.mouseWheel.y } ),
+                  event );
+      break;
+
+    case sf::Event::MouseEntered:
+      // the first move tells which viewport was entered
+      break;
+
+    case sf::Event::MouseLeft:
+      if ( m_hovered != nullptr && m_captured == nullptr )
+      {
+        m_hovered->m_receiver.onEvent( *m_hovered, event );
+        m_hovered = nullptr;
+      }
+      break;
+
+    case sf::Event::Closed:
+      for ( std::size_t i = 0; i < m_viewports.size(); ++i )
+      {
+        auto& viewport = *m_viewports[ i ];
+        if ( viewport.m_isCreated )
+          viewport.m_receiver.onEvent( viewport, event );
+      }
+      break;
+
+    default:
+      // keyboard, text, focus and everything else
+      if ( m_focused != nullptr )
+        m_focused->m_receiver.onEvent( *m_focused, event );
+      break;
+  }
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+void EmbeddedViewportCompositor::routeMouse( EmbeddedViewport * viewport, sf::Event event )
+{
+  if ( viewport == nullptr )
+    return;
+
+  const auto left = viewport->m_pixelArea.left;
+  const auto top = viewport->m_pixelArea.top;
+
+  switch ( event.type )
+  {
+    case sf::Event::MouseMoved:
+      event.mouseMove.x -= left;
+      event.mouseMove.y -= top;
+      break;
+
+    case sf::Event::MouseButtonPressed:
+    case sf::Event::MouseButtonReleased:
+      event.mouseButton.x -= left;
+      event.mouseButton.y -= top;
+      break;
+
+    case sf::Event::MouseWheelScrolled:
+      event.mouseWheelScroll.x -= left;
+      event.mouseWheelScroll.y -= top;
+      break;
+
+    case sf::Event::MouseWheelMoved:
+      event.mouseWheel.x -= left;
+      event.mouseWheel.y -= top;
+      break;
+
+    default:
+      break;
+  }
+
+  viewport->m_receiver.onEvent( *viewport, event );
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+void EmbeddedViewportCompositor::layout( const sf::Vector2u& windowSize )
+{
+  m_windowSize = windowSize;
+  m_needsComposite = true;
+
+  for ( std::size_t i = 0; i < m_viewports.size(); ++i )
+  {
+    auto& viewport = *m_viewports[ i ];
+    if ( viewport.m_isCreated )
+      layoutViewport( viewport );
+    else if ( !viewport.m_isRemoved )
+      createViewport( viewport ); // its texture may fit the new size
+  }
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+void EmbeddedViewportCompositor::layoutViewport( EmbeddedViewport& viewport )
+{
+  // the area it leaves uncovered has to be composited again, even if nothing is redrawn
+  m_needsComposite = true;
+
+  if ( !viewport.layout( m_windowSize ) )
+  {
+    // it has lost its texture, so it is created again on the next resize
+    viewport.m_receiver.onViewportDestroyed( *m_embeddedWindow, viewport );
+    forget( viewport );
+    return;
+  }
+
+  sf::Event resized {};
+  resized.type = sf::Event::Resized;
+  resized.size.width = static_cast< unsigned int >( viewport.m_pixelArea.width );
+  resized.size.height = static_cast< unsigned int >( viewport.m_pixelArea.height );
+  viewport.m_receiver.onEvent( viewport, resized );
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+void EmbeddedViewportCompositor::createViewport( EmbeddedViewport& viewport )
+{
+  viewport.m_textureCharge = EmbeddedMemoryCharge( m_embeddedWindow->getMemoryAccount(), E_MemoryRenderTextures );
+
+  if ( !viewport.layout( m_windowSize ) )
+    return;
+
+  viewport.m_isCreated = true;
+  viewport.m_receiver.onViewportCreated( *m_embeddedWindow, viewport );
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+void EmbeddedViewportCompositor::forget( EmbeddedViewport& viewport )
+{
+  if ( m_focused == &viewport )
+    m_focused = nullptr;
+
+  if ( m_hovered == &viewport )
+    m_hovered = nullptr;
+
+  if ( m_captured == &viewport )
+  {
+    m_captured = nullptr;
+    m_capturedButtons = 0;
+  }
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+void EmbeddedViewportCompositor::eraseRemoved()
+{
+  if ( !m_hasRemoved )
+    return;
+
+  m_viewports.erase( std::remove_if( m_viewports.begin(),
+                                     m_viewports.end(),
+                                     []( const auto& viewport ) { return viewport->m_isRemoved; } ),
+                     m_viewports.end() );
+
+  m_hasRemoved = false;
+}
+
+}
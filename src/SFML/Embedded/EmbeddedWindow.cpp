@@ -3,10 +3,38 @@
 #include "EmbeddedWindowImpl.hpp"
 #include "SFML/Embedded/EmbeddedWindowEventReceiver.hpp"
 #include "SFML/Embedded/EmbeddedLogger.hpp"
+#include "SFML/Embedded/EmbeddedDiagnostics.hpp"
+
+#include <algorithm>
+#include <string>
+
+#include <SFML/Window/Context.hpp>
 
 namespace sf
 {
 
+////////////////////////////////////////////////////////////
+// PRIVATE
+// defined first, since the setters below use it
+template < typename Change >
+bool EmbeddedWindow::applyToFrames( Change&& change )
+{
+  if ( !hasFrameThread() )
+  {
+    change();
+    return true;
+  }
+
+  // the frame thread owns the frame state. it applies the change before its next frame
+  if ( !m_tasks.push( std::forward< Change >( change ) ) )
+  {
+    LOG_ERROR( "the task queue is full. the change to the frames was dropped" );
+    return false;
+  }
+
+  return true;
+}
+
 ////////////////////////////////////////////////////////////
 // PUBLIC
 EmbeddedWindow::EmbeddedWindow( WindowHandle parentHandle,
@@ -36,36 +64,16 @@ EmbeddedWindow::EmbeddedWindow( WindowHandle parentHandle,
                                 EmbeddedWindowEventReceiver &embeddedWindowEvent,
                                 ContextSettings contextSettings,
                                 const Vector2u &startingSize )
-  : m_embeddedWindowEvent( embeddedWindowEvent )
+  : m_embeddedWindowEvent( &embeddedWindowEvent )
 {
-  m_impl = priv::EmbeddedWindowImpl::create(
-    parentHandle,
-    [this]( E_EmbeddedWindowEventState status ) { onObservation( status ); } );
-
-  if ( m_impl )
-  {
-    m_window.create( m_impl->getNativeHandle(), contextSettings );
-
-    // if the size is 0 then use the parent's size
-    if ( startingSize.x == 0 || startingSize.y == 0 )
-      m_window.setSize( m_impl->getParentWindowSize());
-    else
-      m_window.setSize( startingSize );
-
-    // notify successful window creation here
-    LOG_INFO( "created embedded window" );
-
-    m_embeddedWindowEvent.onWindowCreated( *this, m_window );
-  }
-  else
-    LOG_ERROR( "embedded window is invalid" );
+  create( parentHandle, contextSettings, startingSize, &EmbeddedWindow::observeVirtual, this );
 }
 
 ////////////////////////////////////////////////////////////
 // PUBLIC
 EmbeddedWindow::~EmbeddedWindow()
 {
-  delete m_impl;
+  destroy();
 }
 
 ////////////////////////////////////////////////////////////
@@ -120,33 +128,767 @@ sf::Vector2i EmbeddedWindow::getRelativeWindowPosition() const
 [[nodiscard]]
 sf::Vector2i EmbeddedWindow::getCursorPosition() const
 {
+  if ( m_replay.load( std::memory_order_relaxed ) != nullptr )
+    return m_replayCursor;
+
   return m_impl->getCursorPosition();
 }
 
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedWindow::setTaskBudget( sf::Time budget )
+{
+  m_taskBudgetInUS.store( budget.asMicroseconds(), std::memory_order_relaxed );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+[[nodiscard]]
+sf::Time EmbeddedWindow::getTaskBudget() const
+{
+  return sf::microseconds( m_taskBudgetInUS.load( std::memory_order_relaxed ) );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+[[nodiscard]]
+EmbeddedAssetLoader& EmbeddedWindow::getAssetLoader() const
+{
+  return m_assets;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+[[nodiscard]]
+EmbeddedFrameArena& EmbeddedWindow::getFrameArena() const
+{
+  return m_frameArena;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedWindow::setInputLatencyMeasurement( bool enabled )
+{
+  if ( m_impl == nullptr || !m_impl->canTimestampInput() )
+  {
+    LOG_ERROR( "unable to measure input latency without a native window that timestamps its input" );
+    return;
+  }
+
+  applyToFrames( [ this, enabled ] { m_impl->setInputTimestamping( enabled ); } );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+[[nodiscard]]
+bool EmbeddedWindow::isMeasuringInputLatency() const
+{
+  return m_impl != nullptr && m_impl->isTimestampingInput();
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+[[nodiscard]]
+const EmbeddedLatencyHistogram& EmbeddedWindow::getInputLatency() const
+{
+  return m_inputLatency;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedWindow::resetInputLatency()
+{
+  applyToFrames( [ this ] { m_inputLatency.reset(); } );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedWindow::keepLastFrame() const
+{
+  m_isLastFrameKept = true;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+bool EmbeddedWindow::injectSyntheticInput() const
+{
+  return m_impl != nullptr && m_impl->postSyntheticInput();
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+[[nodiscard]]
+const EmbeddedLatencyHistogram& EmbeddedWindow::getFrameCost() const
+{
+  return m_frameCost;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedWindow::resetFrameCost()
+{
+  applyToFrames( [ this ] { m_frameCost.reset(); } );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+bool EmbeddedWindow::startRecording( EmbeddedInputRecording& recording )
+{
+  if ( m_impl == nullptr || !m_impl->canRecordInput() )
+  {
+    LOG_ERROR( "unable to record input without a native window that records its input" );
+    return false;
+  }
+
+  return applyToFrames( [ this, &recording ]
+  {
+    m_replay.store( nullptr, std::memory_order_relaxed );
+
+    recording.clear();
+    m_recording.store( &recording, std::memory_order_relaxed );
+    m_recordingStart = std::chrono::steady_clock::now();
+    m_impl->setInputRecording( &recording );
+  } );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedWindow::stopRecording()
+{
+  applyToFrames( [ this ]
+  {
+    if ( m_impl != nullptr )
+      m_impl->setInputRecording( nullptr );
+
+    m_recording.store( nullptr, std::memory_order_relaxed );
+  } );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+[[nodiscard]]
+bool EmbeddedWindow::isRecording() const
+{
+  return m_recording.load( std::memory_order_relaxed ) != nullptr;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+bool EmbeddedWindow::startReplay( const EmbeddedInputRecording& recording, E_EmbeddedReplayMode mode )
+{
+  if ( m_impl == nullptr || !m_impl->canRecordInput() || recording.getFrames().empty() )
+  {
+    LOG_ERROR( "unable to replay input without a native window that replays input, or without a recording" );
+    return false;
+  }
+
+  return applyToFrames( [ this, &recording, mode ]
+  {
+    // the replayed input would end up in the recording
+    m_impl->setInputRecording( nullptr );
+    m_recording.store( nullptr, std::memory_order_relaxed );
+
+    m_replayMode = mode;
+    m_replayFrame = 0;
+    m_replayStart = std::chrono::steady_clock::now();
+    m_replayCursor = recording.getFrames().front().cursor;
+    m_replay.store( &recording, std::memory_order_relaxed );
+  } );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedWindow::stopReplay()
+{
+  applyToFrames( [ this ] { m_replay.store( nullptr, std::memory_order_relaxed ); } );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+[[nodiscard]]
+bool EmbeddedWindow::isReplaying() const
+{
+  return m_replay.load( std::memory_order_relaxed ) != nullptr;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+[[nodiscard]]
+std::shared_ptr< EmbeddedMemoryAccount > EmbeddedWindow::getMemoryAccount() const
+{
+  return m_memoryAccount;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+[[nodiscard]]
+EmbeddedMemoryUsage EmbeddedWindow::getMemoryUsage() const
+{
+  return m_memoryAccount->getUsage();
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedWindow::setMemoryBudget( uint64_t bytes )
+{
+  m_memoryAccount->setBudget( bytes );
+
+  // a new budget gets a notice of its own
+  applyToFrames( [ this ] { m_isOverMemoryBudget = false; } );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+[[nodiscard]]
+uint64_t EmbeddedWindow::getMemoryBudget() const
+{
+  return m_memoryAccount->getBudget();
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedWindow::setSoftwareFallback( E_EmbeddedSoftwareFallback fallback )
+{
+  applyToFrames( [ this, fallback ]
+  {
+    m_softwareFallback.store( fallback, std::memory_order_relaxed );
+
+    // let a receiver that couldn't render in software try again
+    m_isSoftwareUnsupported = false;
+  } );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+[[nodiscard]]
+E_EmbeddedSoftwareFallback EmbeddedWindow::getSoftwareFallback() const
+{
+  return m_softwareFallback.load( std::memory_order_relaxed );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedWindow::setSoftwareFallbackBudget( sf::Time budget )
+{
+  applyToFrames( [ this, budget ] { m_softwareFallbackBudget = budget; } );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+[[nodiscard]]
+bool EmbeddedWindow::isRenderingInSoftware() const
+{
+  return m_isRenderingInSoftware.load( std::memory_order_relaxed );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+bool EmbeddedWindow::runFrame()
+{
+  if ( !m_isCreated )
+    return false;
+
+  // the frame thread owns the GL context
+  if ( hasFrameThread() )
+  {
+    LOG_ERROR( "frames run on the frame thread. call setHostDriven( true ) to run them from here" );
+    return false;
+  }
+
+  if ( m_isInFrame )
+    return false;
+
+  m_callback( m_context, E_FrameReady );
+  return true;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+bool EmbeddedWindow::setHostDriven( bool isHostDriven )
+{
+  // m_isInFrame belongs to the frame thread while it runs, and the frame
+  // thread can't join itself
+  if ( !m_isCreated || ( hasFrameThread() ? m_impl->isOnFrameThread() : m_isInFrame ) )
+    return false;
+
+  if ( isHostDriven == m_isHostDriven )
+    return true;
+
+  // a frame thread hands the GL context back as it stops
+  if ( !m_impl->setHostDriven( isHostDriven ) )
+  {
+    LOG_WARN( "the embedded window can't be driven by the host" );
+    return false;
+  }
+
+  m_isHostDriven = isHostDriven;
+
+  if ( isHostDriven )
+  {
+    if ( m_hasGlContext )
+      m_window.setActive( true );
+  }
+  else
+  {
+    // same hand over as when the window was created
+    if ( m_impl->hasFrameThread() )
+      m_window.setActive( false );
+
+    m_impl->startFrames();
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+[[nodiscard]]
+bool EmbeddedWindow::isHostDriven() const
+{
+  return m_isHostDriven;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+[[nodiscard]]
+int EmbeddedWindow::getPollDescriptor() const
+{
+  return m_impl != nullptr ? m_impl->getPollDescriptor() : -1;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+bool EmbeddedWindow::processPending()
+{
+  if ( !m_isCreated || !m_isHostDriven || m_isInFrame )
+    return false;
+
+  TRACE_SCOPE( "processPending" );
+  return m_impl->processPending();
+}
+
+////////////////////////////////////////////////////////////
+// PROTECTED
+void EmbeddedWindow::create( WindowHandle parentHandle,
+                             const ContextSettings& contextSettings,
+                             const Vector2u& startingSize,
+                             ObserverCallback callback,
+                             void * context )
+{
+  attach( priv::EmbeddedWindowImpl::create( parentHandle, { callback, context } ),
+          contextSettings,
+          startingSize,
+          callback,
+          context );
+}
+
+////////////////////////////////////////////////////////////
+// PROTECTED
+void EmbeddedWindow::attach( priv::EmbeddedWindowImpl * impl,
+                             const ContextSettings& contextSettings,
+                             const Vector2u& startingSize,
+                             ObserverCallback callback,
+                             void * context )
+{
+  TRACE_SCOPE( "EmbeddedWindow::attach" );
+  m_impl = impl;
+
+  // before anything gets loaded, so that every texture is charged
+  m_memoryAccount->setLabel( "embedded window " + std::to_string( ++smWindowCount ) );
+  m_assets.setMemoryAccount( m_memoryAccount );
+
+  if ( m_impl )
+  {
+    m_window.create( m_impl->getNativeHandle(), contextSettings );
+
+    // without a context (VMs, remote desktops) frames can still be rendered in software
+    m_hasGlContext = m_window.setActive( true );
+    if ( !m_hasGlContext )
+      LOG_WARN( "no OpenGL context for the embedded window" );
+
+    // if the size is 0 then use the parent's size
+    if ( startingSize.x == 0 || startingSize.y == 0 )
+      m_window.setSize( m_impl->getParentWindowSize());
+    else
+      m_window.setSize( startingSize );
+
+    if ( m_isOffscreen && !createOffscreenFrame() )
+    {
+      callback( context, E_Error );
+      return;
+    }
+
+    // notify successful window creation here
+    LOG_INFO( "created embedded window" );
+
+    m_isCreated = true;
+    m_callback = callback;
+    m_context = context;
+    EmbeddedDiagnostics::acquire( E_ResourceRenderWindow );
+    callback( context, E_WindowCreated );
+
+    // the GL context can only be current on one thread. let the frame
+    // thread take it over
+    if ( m_impl->hasFrameThread() )
+      m_window.setActive( false );
+
+    m_impl->startFrames();
+  }
+  else
+    LOG_ERROR( "embedded window is invalid" );
+}
+
+////////////////////////////////////////////////////////////
+// PROTECTED
+void EmbeddedWindow::destroy()
+{
+  TRACE_SCOPE( "EmbeddedWindow::destroy" );
+
+  // the impl notifies E_WindowDestroyed while it shuts down, and stops
+  // its frame thread first. nothing else touches the frame state after that
+  delete m_impl;
+  m_impl = nullptr;
+
+  m_recording.store( nullptr, std::memory_order_relaxed );
+  m_replay.store( nullptr, std::memory_order_relaxed );
+
+  // the impl released its software framebuffer with the native window
+  m_isRenderingInSoftware.store( false, std::memory_order_relaxed );
+  m_softwareCanvas = {};
+  m_softwareSize = {};
+  m_softwareFramebufferCharge.setBytes( 0 );
+  m_framebufferCharge.setBytes( 0 );
+
+  // in case the impl never got to notify
+  if ( m_window.isOpen() )
+  {
+    if ( m_window.setActive( true ) )
+    {
+      m_assets.release();
+      releaseOffscreenFrame();
+    }
+
+    m_window.close();
+  }
+
+  if ( m_isCreated )
+    EmbeddedDiagnostics::release( E_ResourceRenderWindow );
+
+  m_isCreated = false;
+}
+
+////////////////////////////////////////////////////////////
+// PROTECTED
+void EmbeddedWindow::setRenderingOffscreen()
+{
+  m_isOffscreen = true;
+}
+
+////////////////////////////////////////////////////////////
+// PROTECTED
+bool EmbeddedWindow::bindOffscreenFrame()
+{
+  if ( !m_offscreenFrame || !m_hasGlContext || m_isRenderingInSoftware.load( std::memory_order_relaxed ) || m_isLastFrameKept )
+    return false;
+
+  return m_window.setActive( true );
+}
+
 ////////////////////////////////////////////////////////////
 // PROTECTED
 void EmbeddedWindow::onObservation( E_EmbeddedWindowEventState state )
 {
-  switch ( state )
+  TRACE_SCOPE( "EmbeddedWindow::onObservation" );
+  dispatch( *m_embeddedWindowEvent, state );
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+void EmbeddedWindow::beginFrame()
+{
+  m_frameStart = std::chrono::steady_clock::now();
+  m_isInFrame = true;
+  m_isLastFrameKept = false;
+
+  // changes posted from other threads come first, so that this frame sees them
+  {
+    // at most one lap of the queue per frame so that tasks which re-post
+    // themselves cannot starve the frame
+    TRACE_SCOPE( "posted tasks" );
+    m_tasks.drain( getTaskBudget(), m_tasks.getCapacity() );
+  }
+
+  if ( auto * recording = m_recording.load( std::memory_order_relaxed ) )
+  {
+    const auto elapsed = std::chrono::duration_cast< std::chrono::microseconds >( m_frameStart - m_recordingStart );
+    recording->addFrame( sf::microseconds( elapsed.count() ), m_impl->getCursorPosition(), m_window.getSize() );
+  }
+
+  if ( m_replay.load( std::memory_order_relaxed ) != nullptr )
+  {
+    TRACE_SCOPE( "replay input" );
+    replayFrame();
+  }
+
+  updateRenderMode();
+
+  // whatever input arrived until now is polled by this onFrame
+  if ( m_impl->isTimestampingInput() )
+    m_impl->beginInputFrame();
+
+  updateMemoryUsage();
+
+  // give the receiver a chance to shed caches before more textures arrive
+  if ( !m_isMemoryBudgetNoticeDue )
+  {
+    TRACE_SCOPE( "asset uploads" );
+    m_assets.processUploads();
+  }
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+void EmbeddedWindow::endFrame()
+{
+  if ( m_impl->isTimestampingInput() )
+    m_impl->endInputFrame( m_inputLatency );
+
+  m_frameArena.reset();
+
+  const auto cost = sf::microseconds( std::chrono::duration_cast< std::chrono::microseconds >(
+    std::chrono::steady_clock::now() - m_frameStart ).count() );
+  m_frameCost.add( cost );
+
+  // OpenGL is too slow when most of the last second's frames went over budget
+  if ( !m_isRenderingInSoftware.load( std::memory_order_relaxed ) &&
+       m_softwareFallback.load( std::memory_order_relaxed ) == E_SoftwareFallbackWhenSlow )
   {
-    case E_WindowCreated:
-      // cannot call this because the impl is null.
-      // must call this AFTER everything has been created successfully
-      // m_embeddedWindowEvent.onWindowCreated( *this, m_window );
+    if ( cost > m_softwareFallbackBudget )
+      ++m_slowGlFrames;
+
+    if ( ++m_glFrames == SlowFrameWindow )
+    {
+      if ( m_slowGlFrames > SlowFrameWindow / 2 && !m_isSoftwareUnsupported )
+      {
+        LOG_INFO( "{} of {} OpenGL frames went over budget", m_slowGlFrames, SlowFrameWindow );
+        m_isRenderingInSoftware.store( true, std::memory_order_relaxed );
+      }
+
+      m_glFrames = 0;
+      m_slowGlFrames = 0;
+    }
+  }
+
+  m_isInFrame = false;
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+void EmbeddedWindow::replayFrame()
+{
+  const auto * replay = m_replay.load( std::memory_order_relaxed );
+  const auto& frames = replay->getFrames();
+  const auto& inputs = replay->getInputs();
+
+  const auto elapsed = std::chrono::duration_cast< std::chrono::microseconds >( m_frameStart - m_replayStart );
+
+  // in real time, catch up with every frame recorded until now. the input
+  // of frames that ran late is still replayed, only later
+  while ( m_replayFrame < frames.size() )
+  {
+    const auto& frame = frames[ m_replayFrame ];
+    if ( m_replayMode == E_ReplayRealTime && frame.time > sf::microseconds( elapsed.count() ) )
       break;
 
-    case E_FrameReady:
-      m_embeddedWindowEvent.onFrame( *this, m_window );
+    // resizing goes through the native window as well, so SFML reports it
+    if ( frame.size != m_window.getSize() )
+      m_window.setSize( frame.size );
+
+    for ( uint32_t i = frame.firstInput; i < frame.firstInput + frame.inputCount; ++i )
+      m_impl->replayInput( inputs[ i ] );
+
+    m_replayCursor = frame.cursor;
+    ++m_replayFrame;
+
+    if ( m_replayMode == E_ReplayAsFastAsPossible )
+      break;
+  }
+
+  if ( m_replayFrame == frames.size() )
+  {
+    LOG_INFO( "replayed {} frames", frames.size() );
+    m_replay.store( nullptr, std::memory_order_relaxed );
+  }
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+[[nodiscard]]
+bool EmbeddedWindow::hasFrameThread() const
+{
+  return m_impl != nullptr && !m_isHostDriven && m_impl->hasFrameThread();
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+bool EmbeddedWindow::createOffscreenFrame()
+{
+  if ( !m_hasGlContext )
+  {
+    LOG_ERROR( "offscreen frames need an OpenGL context" );
+    return false;
+  }
+
+  // without framebuffer objects, sf::RenderTexture falls back to a context
+  // of its own, which the window's draws can't be redirected to
+  if ( !sf::Context::isExtensionAvailable( "GL_ARB_framebuffer_object" ) &&
+       !sf::Context::isExtensionAvailable( "GL_EXT_framebuffer_object" ) )
+  {
+    LOG_ERROR( "offscreen frames need framebuffer objects" );
+    return false;
+  }
+
+  const auto size = m_window.getSize();
+
+  m_offscreenFrame = std::make_unique< sf::RenderTexture >();
+  if ( !m_offscreenFrame->create( size.x, size.y ) )
+  {
+    LOG_ERROR( "failed to create a {}x{} offscreen frame", size.x, size.y );
+    m_offscreenFrame.reset();
+    return false;
+  }
+
+  m_offscreenFrameCharge.setBytes( static_cast< uint64_t >( size.x ) * size.y * 4 );
+  m_window.setOffscreenTarget( m_offscreenFrame.get() );
+  return true;
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+void EmbeddedWindow::releaseOffscreenFrame()
+{
+  if ( !m_offscreenFrame )
+    return;
+
+  m_window.setOffscreenTarget( nullptr );
+  m_offscreenFrame.reset();
+  m_offscreenFrameCharge.setBytes( 0 );
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+void EmbeddedWindow::updateMemoryUsage()
+{
+  // the driver's own layout is unknown. count a single-sampled front buffer,
+  // and a back buffer and depth/stencil at the context's sample count
+  if ( m_hasGlContext )
+  {
+    const auto size = m_window.getSize();
+    const auto settings = m_window.getSettings();
+    const uint64_t samples = std::max( settings.antialiasingLevel, 1u );
+    const uint64_t bytesPerPixel = 4 + ( 4 + ( settings.depthBits + settings.stencilBits ) / 8 ) * samples;
+
+    m_framebufferCharge.setBytes( static_cast< uint64_t >( size.x ) * size.y * bytesPerPixel );
+  }
+
+  m_heapCharge.setBytes( m_frameArena.getCapacity() +
+                         m_tasks.getCapacity() * EmbeddedTaskQueue::TaskStorageSize );
+
+  // once per crossing, so that a receiver that can't shed enough isn't asked every frame
+  const auto isOverBudget = m_memoryAccount->isOverBudget();
+  if ( isOverBudget && !m_isOverMemoryBudget )
+  {
+    const auto usage = m_memoryAccount->getUsage();
+    LOG_WARN( "embedded window is over its memory budget: {} of {} bytes", usage.getTotalBytes(), usage.budget );
+    m_isMemoryBudgetNoticeDue = true;
+  }
+
+  m_isOverMemoryBudget = isOverBudget;
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+void EmbeddedWindow::updateRenderMode()
+{
+  const auto wasSoftware = m_isRenderingInSoftware.load( std::memory_order_relaxed );
+  auto isSoftware = wasSoftware;
+
+  switch ( m_softwareFallback.load( std::memory_order_relaxed ) )
+  {
+    case E_SoftwareFallbackOff:
+      isSoftware = false;
       break;
 
-    case E_WindowDestroyed:
-      m_embeddedWindowEvent.onWindowDestroyed( *this, m_window );
+    case E_SoftwareFallbackAlways:
+      isSoftware = true;
       break;
 
     default:
-      m_embeddedWindowEvent.onError();
+      // switching to software because of slow frames happens in endFrame
+      isSoftware = isSoftware || !m_hasGlContext;
       break;
   }
+
+  if ( m_isSoftwareUnsupported )
+    isSoftware = false;
+
+  if ( isSoftware == wasSoftware )
+    return;
+
+  LOG_INFO( isSoftware ? "rendering in software" : "rendering with OpenGL" );
+  m_isRenderingInSoftware.store( isSoftware, std::memory_order_relaxed );
+
+  if ( !isSoftware )
+  {
+    m_impl->releaseSoftwareFramebuffer();
+    m_softwareCanvas = {};
+    m_softwareSize = {};
+    m_softwareFramebufferCharge.setBytes( 0 );
+  }
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+EmbeddedSoftwareCanvas * EmbeddedWindow::beginSoftwareFrame()
+{
+  // the framebuffer follows the render window, which follows resizes
+  const auto size = m_window.getSize();
+  if ( size != m_softwareSize )
+  {
+    m_softwareSize = {};
+    m_softwareFramebufferCharge.setBytes( 0 );
+    if ( size.x == 0 || size.y == 0 || !m_impl->resizeSoftwareFramebuffer( size ) )
+      return nullptr;
+
+    m_softwareSize = size;
+    m_softwareFramebufferCharge.setBytes( static_cast< uint64_t >( size.x ) * size.y * 4 );
+  }
+
+  m_softwareCanvas = m_impl->getSoftwareCanvas();
+  return m_softwareCanvas.getPixels() != nullptr ? &m_softwareCanvas : nullptr;
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+void EmbeddedWindow::endSoftwareFrame( bool isDrawn )
+{
+  if ( isDrawn )
+  {
+    m_impl->presentSoftwareFramebuffer();
+    return;
+  }
+
+  // the receiver or the native window can't do it. don't try every frame
+  LOG_WARN( "unable to render in software. rendering with OpenGL" );
+  m_isSoftwareUnsupported = true;
+  updateRenderMode();
+}
+
+////////////////////////////////////////////////////////////
+// STATIC PRIVATE
+void EmbeddedWindow::observeVirtual( void * context, E_EmbeddedWindowEventState state )
+{
+  static_cast< EmbeddedWindow * >( context )->onObservation( state );
 }
 
 }
\ No newline at end of file
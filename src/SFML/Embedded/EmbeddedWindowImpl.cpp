@@ -3,6 +3,9 @@
 #ifdef WIN32
 #include "EmbeddedWindowImplWin32.hpp"
 using EmbeddedWindowImplType = sf::priv::EmbeddedWindowImplWin32;
+#elif defined( __linux__ )
+#include "EmbeddedWindowImplX11.hpp"
+using EmbeddedWindowImplType = sf::priv::EmbeddedWindowImplX11;
 #endif
 
 namespace sf::priv
@@ -10,7 +13,7 @@ namespace sf::priv
 
 EmbeddedWindowImpl * EmbeddedWindowImpl::create(
   ::sf::WindowHandle parentHandle,
-  const std::function< void( E_EmbeddedWindowEventState ) >& observer )
+  const EmbeddedWindowObserver& observer )
 {
   return new EmbeddedWindowImplType( parentHandle, observer );
 }
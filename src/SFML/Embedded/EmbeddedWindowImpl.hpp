@@ -1,31 +1,51 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <memory>
-#include <functional>
+#include <cstdlib>
 
 #include <SFML/Window/WindowHandle.hpp>
 #include <SFML/Graphics/Rect.hpp>
 
 #include "SFML/Embedded/EmbeddedWindowEventState.hpp"
+#include "SFML/Embedded/EmbeddedLatencyHistogram.hpp"
+#include "SFML/Embedded/EmbeddedInputRecording.hpp"
+#include "SFML/Embedded/EmbeddedSoftwareCanvas.hpp"
 
 namespace sf::priv
 {
 
+////////////////////////////////////////////////////////////
+/// \brief Receives the state changes of the native window
+///
+/// A function pointer and context rather than a std::function, so that
+/// every frame costs a single indirect call into EmbeddedWindow.
+////////////////////////////////////////////////////////////
+struct EmbeddedWindowObserver
+{
+  void ( *callback )( void * context, E_EmbeddedWindowEventState state ) { nullptr };
+  void * context { nullptr };
+
+  void operator()( E_EmbeddedWindowEventState state ) const { callback( context, state ); }
+};
+
 class EmbeddedWindowImpl
 {
 public:
 
   [[nodiscard]]
   static EmbeddedWindowImpl * create( WindowHandle parentHandle,
-                                      const std::function< void( E_EmbeddedWindowEventState ) >& observer );
+                                      const EmbeddedWindowObserver& observer );
 
   virtual ~EmbeddedWindowImpl() = default;
 
   [[nodiscard]]
-  virtual WindowHandle getNativeHandle() const { return nullptr; }
+  virtual WindowHandle getNativeHandle() const { return {}; }
 
   [[nodiscard]]
-  virtual WindowHandle getParentNativeHandle() const { return nullptr; }
+  virtual WindowHandle getParentNativeHandle() const { return {}; }
 
   [[nodiscard]]
   virtual sf::Vector2u getParentWindowSize() const { return { 0, 0}; }
@@ -44,5 +64,152 @@ public:
   {
     return { 0, 0 };
   }
+
+  /// checks whether E_FrameReady is notified from a thread of the implementation
+  [[nodiscard]]
+  virtual bool hasFrameThread() const { return false; }
+
+  /// checks whether the calling thread is the implementation's frame thread
+  [[nodiscard]]
+  virtual bool isOnFrameThread() const { return false; }
+
+  /// called once the render window exists. frames may be notified from then on
+  virtual void startFrames() {}
+
+  /// runs the native message loop of a standalone (non-embedded) window until it closes
+  [[nodiscard]]
+  virtual int runMessageLoop() { return EXIT_FAILURE; }
+
+  /// posts a synthetic input event that goes through the same path as real input
+  virtual bool postSyntheticInput() { return false; }
+
+  /// delivers a recorded native input message as if it had just arrived
+  virtual bool replayInput( const EmbeddedRecordedInput& /*input*/ ) { return false; }
+
+  /// checks whether native input reaches recordInput, and can be fed back with replayInput
+  [[nodiscard]]
+  virtual bool canRecordInput() const { return false; }
+
+  /// checks whether native input is timestamped with recordInputArrival as it arrives
+  [[nodiscard]]
+  virtual bool canTimestampInput() const { return false; }
+
+  ////////////////////////////////////////////////////////////
+  /// HOST EVENT LOOP
+  ////////////////////////////////////////////////////////////
+
+  /// \brief stops (or restarts) pacing frames, so that the host's loop drives them through processPending
+  /// \return false if the host can't drive the native window
+  virtual bool setHostDriven( bool /*isHostDriven*/ ) { return false; }
+
+  /// \brief gets a file descriptor that becomes readable when processPending has work. -1 if there is none
+  [[nodiscard]]
+  virtual int getPollDescriptor() const { return -1; }
+
+  /// \brief handles the pending native events and notifies E_FrameReady if a frame is due
+  /// \return true if a frame was notified
+  virtual bool processPending() { return false; }
+
+  ////////////////////////////////////////////////////////////
+  /// SOFTWARE RENDERING
+  ////////////////////////////////////////////////////////////
+
+  /// \brief (re)creates the framebuffer that software frames are drawn into
+  /// \return false if the native window can't present software frames
+  virtual bool resizeSoftwareFramebuffer( const sf::Vector2u& /*size*/ ) { return false; }
+
+  /// \brief gets a canvas over the framebuffer. empty until it is created
+  [[nodiscard]]
+  virtual EmbeddedSoftwareCanvas getSoftwareCanvas() { return {}; }
+
+  /// \brief shows the framebuffer in the native window
+  virtual void presentSoftwareFramebuffer() {}
+
+  /// \brief releases the framebuffer
+  virtual void releaseSoftwareFramebuffer() {}
+
+  ////////////////////////////////////////////////////////////
+  /// INPUT RECORDING
+  ////////////////////////////////////////////////////////////
+
+  /// \brief starts (or stops, with nullptr) adding every native input message to a recording
+  void setInputRecording( EmbeddedInputRecording * recording ) { m_inputRecording = recording; }
+
+  [[nodiscard]]
+  bool isRecordingInput() const { return m_inputRecording != nullptr; }
+
+  ////////////////////////////////////////////////////////////
+  /// INPUT LATENCY
+  ////////////////////////////////////////////////////////////
+
+  using InputClock = std::chrono::steady_clock;
+
+  /// \brief starts or stops timestamping input as it arrives
+  void setInputTimestamping( bool enabled )
+  {
+    m_isTimestampingInput = enabled;
+    m_pendingInputCount = 0;
+    m_frameInputCount = 0;
+  }
+
+  [[nodiscard]]
+  bool isTimestampingInput() const { return m_isTimestampingInput; }
+
+  /// \brief marks the input that arrived so far as handled by the frame that is starting
+  void beginInputFrame()
+  {
+    std::copy_n( m_pendingInputs.begin(), m_pendingInputCount, m_frameInputs.begin() );
+    m_frameInputCount = m_pendingInputCount;
+    m_pendingInputCount = 0;
+  }
+
+  /// \brief records the latency of every input handled by the frame that just ended
+  void endInputFrame( EmbeddedLatencyHistogram& histogram )
+  {
+    const auto now = InputClock::now();
+
+    for ( uint32_t i = 0; i < m_frameInputCount; ++i )
+    {
+      const auto latency = std::chrono::duration_cast< std::chrono::microseconds >( now - m_frameInputs[ i ] );
+      histogram.add( sf::microseconds( latency.count() ) );
+    }
+
+    m_frameInputCount = 0;
+  }
+
+protected:
+
+  /// \brief called by implementations for every input event as it arrives
+  void recordInputArrival( InputClock::time_point arrival )
+  {
+    // the oldest input of a frame has the worst latency, so the rest of a
+    // burst larger than this is the part that can be dropped
+    if ( m_isTimestampingInput && m_pendingInputCount < MaxInputsPerFrame )
+      m_pendingInputs[ m_pendingInputCount++ ] = arrival;
+  }
+
+  /// \brief called by implementations for every input message while recording
+  void recordInput( const EmbeddedRecordedInput& input )
+  {
+    if ( m_inputRecording != nullptr )
+      m_inputRecording->addInput( input );
+  }
+
+private:
+
+  static constexpr uint32_t MaxInputsPerFrame = 64;
+
+  bool m_isTimestampingInput { false };
+
+  // input that arrived since the last frame started
+  std::array< InputClock::time_point, MaxInputsPerFrame > m_pendingInputs {};
+  uint32_t m_pendingInputCount { 0 };
+
+  // input handled by the current frame
+  std::array< InputClock::time_point, MaxInputsPerFrame > m_frameInputs {};
+  uint32_t m_frameInputCount { 0 };
+
+  // receives the native input while a session is recorded
+  EmbeddedInputRecording * m_inputRecording { nullptr };
 };
 }
\ No newline at end of file
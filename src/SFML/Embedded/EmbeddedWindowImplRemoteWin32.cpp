@@ -0,0 +1,347 @@
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+
+#include "EmbeddedWindowImplRemoteWin32.hpp"
+#include "EmbeddedWindowImplWin32.hpp"
+#include "SFML/Embedded/EmbeddedLogger.hpp"
+#include "SFML/Embedded/EmbeddedTracer.hpp"
+
+#include <string>
+#include <tuple>
+
+#include <windowsx.h>
+
+#include <SFML/OpenGL.hpp>
+
+namespace sf::priv
+{
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+EmbeddedWindowImplRemoteWin32::EmbeddedWindowImplRemoteWin32(const std::string& channelName,
+                                                             const EmbeddedWindowObserver& observer)
+    : m_observer( observer )
+{
+    if ( !openChannel( channelName ) || !createWindow() )
+    {
+        // notify that an error has occurred
+        m_observer( E_Error );
+        LOG_ERROR( "failed to connect to host channel {}", channelName );
+        return;
+    }
+
+    m_observer( E_WindowCreated );
+
+    m_timerResult = ::SetTimer( m_hwnd, 1, USER_TIMER_MINIMUM, processTimerExpiry );
+    if ( m_timerResult == 0 )
+    {
+        m_observer( E_Error );
+        LOG_ERROR( "failed to create windows timer. Error code: {}", ::GetLastError() );
+    }
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+EmbeddedWindowImplRemoteWin32::~EmbeddedWindowImplRemoteWin32()
+{
+    if ( m_hwnd != nullptr )
+    {
+        // notify that window is about to be destroyed
+        m_observer( E_WindowDestroyed );
+
+        if ( m_timerResult != 0 )
+            ::KillTimer( m_hwnd, m_timerResult );
+
+        ::RemovePropA( m_hwnd, smInstanceProperty );
+        ::DestroyWindow( m_hwnd );
+        ::UnregisterClassA( m_classname.c_str(), EmbeddedWindowImplWin32::Win32Helper::getModuleInstance() );
+        m_hwnd = nullptr;
+    }
+
+    if ( m_view != nullptr )
+        ::UnmapViewOfFile( m_view );
+
+    for ( auto handle : { m_mapping, m_frameEvent, m_hostProcess } )
+    {
+        if ( handle != nullptr )
+            ::CloseHandle( handle );
+    }
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+sf::WindowHandle EmbeddedWindowImplRemoteWin32::getNativeHandle() const
+{
+    return m_hwnd;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+sf::Vector2u EmbeddedWindowImplRemoteWin32::getParentWindowSize() const
+{
+    // the frame size is fixed by the host
+    if ( !m_channel )
+        return { 0, 0 };
+
+    return { m_channel->getHeader().width, m_channel->getHeader().height };
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+uint32_t EmbeddedWindowImplRemoteWin32::getPollRateInMS() const
+{
+    return static_cast< uint32_t >( USER_TIMER_MINIMUM );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+sf::Vector2i EmbeddedWindowImplRemoteWin32::getCursorPosition() const
+{
+    // the cursor is over the host's presenter window, not this one
+    if ( !m_channel )
+        return { 0, 0 };
+
+    const auto& header = m_channel->getHeader();
+    return { header.cursorX.load( std::memory_order_relaxed ), header.cursorY.load( std::memory_order_relaxed ) };
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+int EmbeddedWindowImplRemoteWin32::runMessageLoop()
+{
+    if ( m_hwnd == nullptr )
+        return EXIT_FAILURE;
+
+    // the render window is created from a foreign handle, so SFML leaves the
+    // message pump to us. the timer posts WM_QUIT once the host is done
+    ::MSG msg {};
+    while ( ::GetMessageA( &msg, nullptr, 0, 0 ) > 0 )
+    {
+        ::TranslateMessage( &msg );
+        ::DispatchMessageA( &msg );
+    }
+
+    return static_cast< int >( msg.wParam );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+bool EmbeddedWindowImplRemoteWin32::replayInput( const EmbeddedRecordedInput& input )
+{
+    // the host process decides what comes through the channel, so only
+    // pass on what a recording could hold
+    if ( !EmbeddedInputRecording::isRecordedMessage( input.message ) )
+    {
+        LOG_WARN( "not replaying message {}, which isn't input", input.message );
+        return false;
+    }
+
+    auto lParam = static_cast< LPARAM >( input.lParam );
+
+    // wheel messages carry screen coordinates, so map them onto this window
+    if ( input.message == WM_MOUSEWHEEL || input.message == WM_MOUSEHWHEEL )
+    {
+        ::POINT point { GET_X_LPARAM( lParam ), GET_Y_LPARAM( lParam ) };
+        ::ClientToScreen( m_hwnd, &point );
+        lParam = MAKELPARAM( point.x, point.y );
+    }
+
+    // sent rather than posted so that SFML has queued the sf::Events
+    // before onFrame polls for them
+    ::SendMessageA( m_hwnd, input.message, static_cast< WPARAM >( input.wParam ), lParam );
+    return true;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedWindowImplRemoteWin32::publishFrame()
+{
+    TRACE_SCOPE( "publish frame" );
+    const auto& header = m_channel->getHeader();
+
+    // the renderer has just bound the offscreen frame, whose color attachment
+    // is the read buffer. BGRA rows come back bottom-up, which is exactly the
+    // layout of the host's DIB sections
+    ::glPixelStorei( GL_PACK_ALIGNMENT, 4 );
+    ::glReadPixels( 0,
+                    0,
+                    ( GLsizei )header.width,
+                    ( GLsizei )header.height,
+                    GL_BGRA_EXT,
+                    GL_UNSIGNED_BYTE,
+                    m_channel->getFrame( m_frame ) );
+
+    ::LARGE_INTEGER ticks {};
+    ::QueryPerformanceCounter( &ticks );
+
+    m_channel->publish( m_frame, ticks.QuadPart );
+    ::SetEvent( m_frameEvent );
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+bool EmbeddedWindowImplRemoteWin32::openChannel( const std::string& channelName )
+{
+    if ( channelName.empty() )
+    {
+        LOG_ERROR( "no channel name. was the helper launched by an EmbeddedRemoteWindow?" );
+        return false;
+    }
+
+    m_mapping = ::OpenFileMappingA( FILE_MAP_ALL_ACCESS, FALSE, channelName.c_str() );
+    if ( m_mapping == nullptr )
+    {
+        LOG_ERROR( "failed to open shared memory. Error code: {}", ::GetLastError() );
+        return false;
+    }
+
+    m_view = ::MapViewOfFile( m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0 );
+    if ( m_view == nullptr )
+    {
+        LOG_ERROR( "failed to map shared memory. Error code: {}", ::GetLastError() );
+        return false;
+    }
+
+    m_channel = std::make_unique< EmbeddedRemoteChannel >( m_view );
+    if ( !m_channel->isValid() )
+    {
+        LOG_ERROR( "shared memory was created by an incompatible host" );
+        m_channel.reset();
+        return false;
+    }
+
+    m_frameEvent = ::OpenEventA( EVENT_MODIFY_STATE, FALSE, ( channelName + "-frame" ).c_str() );
+    if ( m_frameEvent == nullptr )
+    {
+        LOG_ERROR( "failed to open frame event. Error code: {}", ::GetLastError() );
+        return false;
+    }
+
+    m_hostProcess = ::OpenProcess( SYNCHRONIZE, FALSE, m_channel->getHeader().hostProcessId );
+    if ( m_hostProcess == nullptr )
+        LOG_WARN( "unable to watch the host process. Error code: {}", ::GetLastError() );
+
+    // frame 0 always starts out with the helper
+    m_frame = 0;
+    return true;
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+bool EmbeddedWindowImplRemoteWin32::createWindow()
+{
+    const auto hInstance = EmbeddedWindowImplWin32::Win32Helper::getModuleInstance();
+    m_classname = EmbeddedWindowImplWin32::Win32Helper::createUniqueName();
+    if ( m_classname.empty() )
+        return false;
+
+    ::WNDCLASSA wndClass {};
+    wndClass.style = CS_OWNDC;
+    wndClass.lpfnWndProc = processWndEvent;
+    wndClass.hInstance = hInstance;
+    wndClass.lpszClassName = m_classname.c_str();
+
+    if ( ::RegisterClassA( &wndClass ) == 0 )
+    {
+        LOG_ERROR( "failed to register window class. Error code: {}", ::GetLastError() );
+        m_classname.clear();
+        return false;
+    }
+
+    const auto& header = m_channel->getHeader();
+
+    // a tool window that is never shown. it only provides the GL context and
+    // receives the replayed input; frames are drawn offscreen
+    m_hwnd = ::CreateWindowExA(
+        WS_EX_TOOLWINDOW | WS_EX_NOACTIVATE,
+        m_classname.c_str(),
+        "__remoteWindowName",
+        WS_POPUP,
+        0,
+        0,
+        ( int )header.width,
+        ( int )header.height,
+        nullptr,
+        nullptr,
+        hInstance,
+        nullptr );
+
+    if ( m_hwnd == nullptr )
+    {
+        LOG_ERROR( "failed to create remote window. Error Code: {}", ::GetLastError() );
+        ::UnregisterClassA( m_classname.c_str(), hInstance );
+        return false;
+    }
+
+    ::SetPropA( m_hwnd, smInstanceProperty, this );
+    return true;
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+bool EmbeddedWindowImplRemoteWin32::isHostGone() const
+{
+    if ( m_channel->getHeader().shutdown.load( std::memory_order_acquire ) != 0 )
+        return true;
+
+    return m_hostProcess != nullptr && ::WaitForSingleObject( m_hostProcess, 0 ) == WAIT_OBJECT_0;
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+void EmbeddedWindowImplRemoteWin32::replayRemoteInput()
+{
+    EmbeddedRemoteInput input {};
+    while ( m_channel->popInput( input ) )
+    {
+        // the host already made every position relative to its window, which
+        // is also how recordings store them
+        const EmbeddedRecordedInput recorded { input.message, input.wParam, input.lParam };
+
+        recordInput( recorded );
+        replayInput( recorded );
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// STATIC PRIVATE
+LRESULT EmbeddedWindowImplRemoteWin32::processWndEvent(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
+{
+    return ::DefWindowProcA( hwnd, msg, wParam, lParam );
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// STATIC PRIVATE
+void EmbeddedWindowImplRemoteWin32::processTimerExpiry(HWND hwnd, UINT wmTimerMsg, UINT_PTR timerId, DWORD currentSysTime)
+{
+    std::ignore = wmTimerMsg;
+    std::ignore = currentSysTime;
+
+    TRACE_SCOPE( "processTimerExpiry" );
+
+    auto * impl = static_cast< EmbeddedWindowImplRemoteWin32 * >( ::GetPropA( hwnd, smInstanceProperty ) );
+    if ( impl == nullptr )
+    {
+        LOG_ERROR( "timer is running but remote window not found. stopping timer." );
+        ::KillTimer( hwnd, timerId );
+        return;
+    }
+
+    if ( impl->isHostGone() )
+    {
+        LOG_INFO( "host closed the channel. shutting down helper." );
+        ::KillTimer( hwnd, timerId );
+        impl->m_timerResult = 0;
+        ::PostQuitMessage( EXIT_SUCCESS );
+        return;
+    }
+
+    impl->replayRemoteInput();
+
+    // notify that a frame is ready to be processed. the renderer publishes
+    // it, if it was drawn
+    impl->m_observer( E_FrameReady );
+}
+
+}
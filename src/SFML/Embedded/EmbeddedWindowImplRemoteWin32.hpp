@@ -0,0 +1,143 @@
+#pragma once
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+
+#include <Windows.h>
+
+#include <memory>
+#include <string>
+
+#include <SFML/Window/WindowHandle.hpp>
+#include <SFML/System/Vector2.hpp>
+
+#include "EmbeddedWindowImpl.hpp"
+#include "EmbeddedRemoteChannel.hpp"
+
+namespace sf::priv
+{
+
+////////////////////////////////////////////////////////////
+/// \brief Windows implementation of the helper side of a remote window
+///
+/// Creates a hidden top-level window for the render window, replays the
+/// input forwarded by the host into it and publishes the frames the
+/// renderer drew offscreen into the shared memory created by the host.
+////////////////////////////////////////////////////////////
+class EmbeddedWindowImplRemoteWin32 : public sf::priv::EmbeddedWindowImpl
+{
+public:
+
+    // prevent default ctor and copying
+    EmbeddedWindowImplRemoteWin32() = delete;
+    EmbeddedWindowImplRemoteWin32(const EmbeddedWindowImplRemoteWin32& other) = delete;
+    EmbeddedWindowImplRemoteWin32& operator=(const EmbeddedWindowImplRemoteWin32& other) = delete;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Connect to the host and create the invisible window
+    ///
+    /// \param channelName name of the shared memory created by the host
+    /// \param observer callback related to state of native window
+    ////////////////////////////////////////////////////////////
+    EmbeddedWindowImplRemoteWin32(const std::string& channelName,
+                                  const EmbeddedWindowObserver& observer);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Destructor
+    ///
+    ////////////////////////////////////////////////////////////
+    ~EmbeddedWindowImplRemoteWin32() override;
+
+    [[nodiscard]]
+    sf::WindowHandle getNativeHandle() const override;
+
+    [[nodiscard]]
+    sf::Vector2u getParentWindowSize() const override;
+
+    [[nodiscard]]
+    uint32_t getPollRateInMS() const override;
+
+    [[nodiscard]]
+    sf::Vector2i getCursorPosition() const override;
+
+    [[nodiscard]]
+    int runMessageLoop() override;
+
+    bool replayInput( const EmbeddedRecordedInput& input ) override;
+
+    [[nodiscard]]
+    bool canRecordInput() const override { return true; }
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Reads the bound framebuffer into the shared memory and hands it to the host
+    ///
+    /// Called by the renderer after every frame that was drawn offscreen.
+    ////////////////////////////////////////////////////////////
+    void publishFrame();
+
+private:
+
+    /////////////////////////////////////////////////////////////////////////////
+    /// CHANNEL AND WINDOW SETUP
+    /////////////////////////////////////////////////////////////////////////////
+
+    /////////////////////////////////////////////////////////////////////////////
+    bool openChannel( const std::string& channelName );
+
+    /////////////////////////////////////////////////////////////////////////////
+    bool createWindow();
+
+    /////////////////////////////////////////////////////////////////////////////
+    /// FRAME PROCESSING
+    /////////////////////////////////////////////////////////////////////////////
+
+    /////////////////////////////////////////////////////////////////////////////
+    bool isHostGone() const;
+
+    /////////////////////////////////////////////////////////////////////////////
+    void replayRemoteInput();
+
+    /////////////////////////////////////////////////////////////////////////////
+    /// WINAPI CALLBACKS
+    /////////////////////////////////////////////////////////////////////////////
+
+    /////////////////////////////////////////////////////////////////////////////
+    static LRESULT WINAPI processWndEvent( HWND hwnd,
+                                           UINT msg,
+                                           WPARAM wParam,
+                                           LPARAM lParam );
+
+    /////////////////////////////////////////////////////////////////////////////
+    static void WINAPI processTimerExpiry( HWND hwnd,
+                                          UINT wmTimerMsg,
+                                          UINT_PTR timerId,
+                                          DWORD currentSysTime );
+
+private:
+
+    EmbeddedWindowObserver m_observer;
+
+    // shared memory created by the host
+    HANDLE m_mapping { nullptr };
+    void * m_view { nullptr };
+    std::unique_ptr< EmbeddedRemoteChannel > m_channel;
+
+    // signalled after every published frame
+    HANDLE m_frameEvent { nullptr };
+
+    // used to notice a host that exits without closing the channel
+    HANDLE m_hostProcess { nullptr };
+
+    // frame of the triple buffer currently owned by this process
+    uint32_t m_frame { 0 };
+
+    std::string m_classname;
+    HWND m_hwnd { nullptr };
+    UINT_PTR m_timerResult { 0 };
+
+    // timer callbacks look up their instance through this window property
+    inline static const char * smInstanceProperty = "sfml-embedded-remote";
+};
+
+}
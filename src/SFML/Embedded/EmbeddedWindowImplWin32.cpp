@@ -4,21 +4,18 @@
 
 #include "EmbeddedWindowImplWin32.hpp"
 #include "SFML/Embedded/EmbeddedLogger.hpp"
+#include "SFML/Embedded/EmbeddedTracer.hpp"
+#include "SFML/Embedded/EmbeddedDiagnostics.hpp"
 
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <tuple>
 
 #include <rpc.h>
-
-//#ifdef RPC_USE_NATIVE_WCHAR
-#ifdef UNICODE
-using PTR_RPC_STR = RPC_WSTR*;
-#else
-using PTR_RPC_STR = RPC_CSTR*;
-#endif
+#include <windowsx.h>
 
 // TODO: this requires MSVC and may preclude mingw or other non-msvc windows toolchains
-// BUG: from time to time, in non-embedded applications, a child window may fail when running multiple children
 #ifdef _MSC_VER
 EXTERN_C IMAGE_DOS_HEADER __ImageBase;
 #pragma warning(disable: 4047)
@@ -32,9 +29,11 @@ namespace sf::priv
 ////////////////////////////////////////////////////////////
 // PUBLIC
 EmbeddedWindowImplWin32::EmbeddedWindowImplWin32(sf::WindowHandle parentHandle,
-                                           const std::function<void(E_EmbeddedWindowEventState)>& observer)
+                                           const EmbeddedWindowObserver& observer)
     : m_observer( observer)
 {
+    TRACE_SCOPE( "create child window" );
+
     if (!createChildWindow(parentHandle))
     {
         // notify that an error has occurred
@@ -47,32 +46,31 @@ EmbeddedWindowImplWin32::EmbeddedWindowImplWin32(sf::WindowHandle parentHandle,
 // PUBLIC
 EmbeddedWindowImplWin32::~EmbeddedWindowImplWin32()
 {
+    TRACE_SCOPE( "destroy child window" );
+
+    releaseSoftwareFramebuffer();
+
     if ( m_win32.childHwnd != nullptr )
     {
         // notify that window is about to be destroyed
         m_observer(E_WindowDestroyed);
 
         // stop the callbacks
-        if ( m_win32.timerResult != 0 )
-        {
-            ::KillTimer( m_win32.childHwnd, m_win32.timerResult );
-            m_win32.timerResult = 0;
-        }
-
-        // SFML takes care of the following whenever it closes the window
-        //        ::UnregisterClass( m_wndData.classname.data(), m_wndData.hInstance );
-        //        ::DestroyWindow( m_wndData.childHwnd );
+        stopMessagePump();
 
-        auto it = smWndMap.find( m_win32.childHwnd );
-        if ( it != smWndMap.end() )
-            smWndMap.erase( it );
-        else // something terrible has gone wrong!
-            LOG_ERROR( "unable to properly shut down child HWND because it is not mapped!" );
+        // SFML only detaches from windows it didn't create (it already has,
+        // while E_WindowDestroyed was dispatched), so destroying it is up to us
+        ::RemoveProp( m_win32.childHwnd, smInstanceProperty );
+        ::DestroyWindow( m_win32.childHwnd );
+        EmbeddedDiagnostics::release( E_ResourceNativeWindow );
 
         // shutdown can get called prior to the destructor, so mark this as invalid
         m_win32.childHwnd = nullptr;
     }
     // else: child has already been shutdown, which is odd
+
+    if ( !m_win32.classname.empty() )
+        unregisterWindowClass();
 }
 
 ////////////////////////////////////////////////////////////
@@ -153,19 +151,185 @@ sf::Vector2i EmbeddedWindowImplWin32::getCursorPosition() const
   return { rpos.x, rpos.y };
 }
 
+////////////////////////////////////////////////////////////
+// PUBLIC
+bool EmbeddedWindowImplWin32::postSyntheticInput()
+{
+    // posted rather than sent (or injected with SendInput), so that it waits
+    // in the host's queue like real input but leaves the real cursor alone
+    ::RECT clientRect {};
+    ::GetClientRect( m_win32.childHwnd, &clientRect );
+
+    const auto x = ( clientRect.right - clientRect.left ) / 2;
+    const auto y = ( clientRect.bottom - clientRect.top ) / 2;
+
+    if ( !::PostMessage( m_win32.childHwnd, WM_MOUSEMOVE, 0, MAKELPARAM( x, y ) ) )
+    {
+        LOG_ERROR( "failed to post synthetic input. Error code: {}", ::GetLastError() );
+        return false;
+    }
+
+    return true;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+bool EmbeddedWindowImplWin32::replayInput( const EmbeddedRecordedInput& input )
+{
+    // anything else could make the window do what no user input does
+    if ( !isRecordedMessage( static_cast< UINT >( input.message ) ) )
+    {
+        LOG_WARN( "not replaying message {}, which isn't input", input.message );
+        return false;
+    }
+
+    auto lParam = static_cast< LPARAM >( input.lParam );
+
+    // wheel positions were recorded relative to the window, see recordMessage
+    if ( input.message == WM_MOUSEWHEEL || input.message == WM_MOUSEHWHEEL )
+    {
+        ::POINT position { GET_X_LPARAM( lParam ), GET_Y_LPARAM( lParam ) };
+        ::ClientToScreen( m_win32.childHwnd, &position );
+        lParam = MAKELPARAM( position.x, position.y );
+    }
+
+    // sent rather than posted, so that SFML has queued the event by the
+    // time the frame that replays it polls its events
+    ::SendMessage( m_win32.childHwnd,
+                   static_cast< UINT >( input.message ),
+                   static_cast< WPARAM >( input.wParam ),
+                   lParam );
+    return true;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+bool EmbeddedWindowImplWin32::setHostDriven( bool isHostDriven )
+{
+    if ( m_win32.childHwnd == nullptr )
+        return false;
+
+    // native messages already arrive through the host's message loop, so
+    // only the timer's frames are handed over
+    if ( isHostDriven )
+        stopMessagePump();
+    else if ( m_win32.timerResult == 0 && !startMessagePump() )
+        return false;
+
+    m_isHostDriven = isHostDriven;
+
+    LOG_DEBUG( isHostDriven ? "frames are driven by the host" : "frames are driven by the timer" );
+    return true;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+bool EmbeddedWindowImplWin32::processPending()
+{
+    if ( !m_isHostDriven || m_win32.childHwnd == nullptr )
+        return false;
+
+    // the host's timer paces the frames
+    m_observer( E_FrameReady );
+    return true;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+bool EmbeddedWindowImplWin32::resizeSoftwareFramebuffer( const sf::Vector2u& size )
+{
+    releaseSoftwareFramebuffer();
+
+    ::BITMAPINFO info {};
+    info.bmiHeader.biSize = sizeof( info.bmiHeader );
+    info.bmiHeader.biWidth = static_cast< LONG >( size.x );
+    info.bmiHeader.biHeight = -static_cast< LONG >( size.y ); // top-down
+    info.bmiHeader.biPlanes = 1;
+    info.bmiHeader.biBitCount = 32;
+    info.bmiHeader.biCompression = BI_RGB;
+
+    m_softwareDc = ::CreateCompatibleDC( nullptr );
+    m_softwareBitmap = ::CreateDIBSection( m_softwareDc, &info, DIB_RGB_COLORS, &m_softwarePixels, nullptr, 0 );
+
+    if ( m_softwareDc == nullptr || m_softwareBitmap == nullptr )
+    {
+        LOG_ERROR( "failed to create software framebuffer. Error code: {}", ::GetLastError() );
+        releaseSoftwareFramebuffer();
+        return false;
+    }
+
+    m_previousBitmap = ::SelectObject( m_softwareDc, m_softwareBitmap );
+    m_softwareSize = size;
+    EmbeddedDiagnostics::acquire( E_ResourceSoftwareFramebuffer );
+    return true;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+EmbeddedSoftwareCanvas EmbeddedWindowImplWin32::getSoftwareCanvas()
+{
+    if ( m_softwarePixels == nullptr )
+        return {};
+
+    // GDI may still be reading the bitmap for the last blit
+    ::GdiFlush();
+
+    // 32-bit DIB rows are never padded
+    return { static_cast< uint32_t * >( m_softwarePixels ), m_softwareSize, m_softwareSize.x };
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedWindowImplWin32::presentSoftwareFramebuffer()
+{
+    if ( m_softwareDc == nullptr )
+        return;
+
+    HDC windowDc = ::GetDC( m_win32.childHwnd );
+    ::BitBlt( windowDc,
+              0,
+              0,
+              static_cast< int >( m_softwareSize.x ),
+              static_cast< int >( m_softwareSize.y ),
+              m_softwareDc,
+              0,
+              0,
+              SRCCOPY );
+    ::ReleaseDC( m_win32.childHwnd, windowDc );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedWindowImplWin32::releaseSoftwareFramebuffer()
+{
+    if ( m_softwareDc != nullptr && m_previousBitmap != nullptr )
+        ::SelectObject( m_softwareDc, m_previousBitmap );
+
+    if ( m_softwareBitmap != nullptr )
+    {
+        ::DeleteObject( m_softwareBitmap );
+        EmbeddedDiagnostics::release( E_ResourceSoftwareFramebuffer );
+    }
+
+    if ( m_softwareDc != nullptr )
+        ::DeleteDC( m_softwareDc );
+
+    m_softwareDc = nullptr;
+    m_softwareBitmap = nullptr;
+    m_previousBitmap = nullptr;
+    m_softwarePixels = nullptr;
+    m_softwareSize = {};
+}
+
 ////////////////////////////////////////////////////////////
 // PRIVATE
 bool EmbeddedWindowImplWin32::createChildWindow(HWND parentHwnd)
 {
     m_win32.parentHwnd = parentHwnd;
-    m_win32.classname = Win32Helper::createUniqueName();
-
-    if ( m_win32.classname.empty() )
-        LOG_WARN( "failed to create class name for Win32 Window. attempting to create window anyway." );
 
     if ( registerWindowClass() && createWindow() )
     {
-        smWndMap.insert( { m_win32.childHwnd, this } );
+        ::SetProp( m_win32.childHwnd, smInstanceProperty, this );
         if ( !::AllowSetForegroundWindow( ASFW_ANY ) )
           LOG_WARN( "unable to allow foreground settings" );
         else
@@ -202,10 +366,10 @@ bool EmbeddedWindowImplWin32::createWindow()
     if ( parentWndSize.x == 0 || parentWndSize.y == 0 )
         LOG_WARN( "parent wnd size not found. scaling issues may occur" );
 
-    m_win32.childHwnd = ::CreateWindowEx(
+    m_win32.childHwnd = ::CreateWindowExA(
         WS_EX_NOINHERITLAYOUT,
-        reinterpret_cast< PTR_STR >( m_win32.classname.data() ),
-        reinterpret_cast< PTR_STR >( "__innerWindowName" ),
+        m_win32.classname.c_str(),
+        "__innerWindowName",
         WS_CHILD | WS_CLIPCHILDREN | WS_CLIPSIBLINGS | WS_VISIBLE,
         CW_USEDEFAULT,
         CW_USEDEFAULT,
@@ -222,6 +386,7 @@ bool EmbeddedWindowImplWin32::createWindow()
         return false;
     }
 
+    EmbeddedDiagnostics::acquire( E_ResourceNativeWindow );
     return true;
 }
 
@@ -229,32 +394,70 @@ bool EmbeddedWindowImplWin32::createWindow()
 // PRIVATE
 bool EmbeddedWindowImplWin32::registerWindowClass()
 {
-    const ::WNDCLASS wndClass =
-        {
-            CS_GLOBALCLASS | CS_DBLCLKS,
-            processWndEvent,
-            0,
-            0,
-            hImageBaseInstance,
-            nullptr, nullptr, nullptr, nullptr,
-            reinterpret_cast< PTR_STR >( m_win32.classname.data() )
-        };
-
-    if ( ::RegisterClass( &wndClass ) == 0 )
+    // one class for every instance in this module. the name is still unique
+    // so that several plugins built on this library can share a host process
+    std::unique_lock< std::mutex > lock( smClassMutex );
+
+    if ( smClassUsers == 0 )
     {
-        LOG_ERROR( "failed to register window class. Error code: {}", ::GetLastError() );
-        return false;
+        smClassname = Win32Helper::createUniqueName();
+        if ( smClassname.empty() )
+        {
+            LOG_ERROR( "failed to create class name for Win32 Window" );
+            return false;
+        }
+
+        const ::WNDCLASSA wndClass =
+            {
+                CS_GLOBALCLASS | CS_DBLCLKS,
+                processWndEvent,
+                0,
+                0,
+                hImageBaseInstance,
+                nullptr, nullptr, nullptr, nullptr,
+                smClassname.c_str()
+            };
+
+        if ( ::RegisterClassA( &wndClass ) == 0 )
+        {
+            LOG_ERROR( "failed to register window class. Error code: {}", ::GetLastError() );
+            smClassname.clear();
+            return false;
+        }
+
+        EmbeddedDiagnostics::acquire( E_ResourceWindowClass );
     }
 
+    ++smClassUsers;
+    m_win32.classname = smClassname;
     return true;
 }
 
+/////////////////////////////////////////////////////////////////////////////
+// PRIVATE
+void EmbeddedWindowImplWin32::unregisterWindowClass()
+{
+    std::unique_lock< std::mutex > lock( smClassMutex );
+    m_win32.classname.clear();
+
+    if ( smClassUsers == 0 || --smClassUsers > 0 )
+        return;
+
+    if ( !::UnregisterClassA( smClassname.c_str(), hImageBaseInstance ) )
+        LOG_ERROR( "failed to unregister window class. Error code: {}", ::GetLastError() );
+    else
+        EmbeddedDiagnostics::release( E_ResourceWindowClass );
+
+    smClassname.clear();
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // PRIVATE
 bool EmbeddedWindowImplWin32::startMessagePump()
 {
+    // timer ids only have to be unique per window
     m_win32.timerResult = ::SetTimer( m_win32.childHwnd,
-                                     smTimerIdCounter,
+                                     FrameTimerId,
                                      USER_TIMER_MINIMUM,
                                      processTimerExpiry );
 
@@ -264,16 +467,92 @@ bool EmbeddedWindowImplWin32::startMessagePump()
         return false;
     }
 
-    // TODO: unlikely to hit UINT32_MAX but it is theoretically possible
-    ++smTimerIdCounter;
+    EmbeddedDiagnostics::acquire( E_ResourceTimer );
     return true;
 }
 
+/////////////////////////////////////////////////////////////////////////////
+// PRIVATE
+void EmbeddedWindowImplWin32::stopMessagePump()
+{
+    if ( m_win32.timerResult == 0 )
+        return;
+
+    ::KillTimer( m_win32.childHwnd, m_win32.timerResult );
+    m_win32.timerResult = 0;
+    EmbeddedDiagnostics::release( E_ResourceTimer );
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// STATIC PRIVATE
+bool EmbeddedWindowImplWin32::isInputMessage( UINT msg )
+{
+    return ( msg >= WM_MOUSEFIRST && msg <= WM_MOUSELAST ) ||
+           ( msg >= WM_KEYFIRST && msg <= WM_KEYLAST );
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// PRIVATE
+void EmbeddedWindowImplWin32::timestampInput()
+{
+    // the message may have waited in the host's queue for a while (that's
+    // what a stalled host looks like), so date it back to when it was posted.
+    // both tick counts are coarse, but the wait is what matters here
+    const auto queuedInMS = static_cast< LONG >( ::GetTickCount() - static_cast< DWORD >( ::GetMessageTime() ) );
+    const auto queued = std::chrono::milliseconds( std::clamp< LONG >( queuedInMS, 0, 1000 ) );
+
+    recordInputArrival( InputClock::now() - queued );
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// STATIC PRIVATE
+bool EmbeddedWindowImplWin32::isRecordedMessage( UINT msg )
+{
+    return EmbeddedInputRecording::isRecordedMessage( static_cast< uint32_t >( msg ) );
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// PRIVATE
+void EmbeddedWindowImplWin32::recordMessage( UINT msg, WPARAM wParam, LPARAM lParam )
+{
+    // the wheel is the one mouse message with screen coordinates. keep the
+    // recording independent of where the window was on screen
+    if ( msg == WM_MOUSEWHEEL || msg == WM_MOUSEHWHEEL )
+    {
+        ::POINT position { GET_X_LPARAM( lParam ), GET_Y_LPARAM( lParam ) };
+        ::ScreenToClient( m_win32.childHwnd, &position );
+        lParam = MAKELPARAM( position.x, position.y );
+    }
+
+    // focus messages carry the handle of the other window, which means
+    // nothing in another session
+    if ( msg == WM_SETFOCUS || msg == WM_KILLFOCUS )
+        wParam = 0;
+
+    recordInput( { static_cast< uint32_t >( msg ),
+                   static_cast< uint64_t >( wParam ),
+                   static_cast< int64_t >( lParam ) } );
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // STATIC PRIVATE
 LRESULT EmbeddedWindowImplWin32::processWndEvent(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 {
-    return ::DefWindowProc( hwnd, msg, wParam, lParam );
+    // SFML subclasses the window and passes every message on to here
+    if ( isRecordedMessage( msg ) )
+    {
+        auto * impl = static_cast< EmbeddedWindowImplWin32 * >( ::GetProp( hwnd, smInstanceProperty ) );
+        if ( impl != nullptr )
+        {
+            if ( impl->isTimestampingInput() && isInputMessage( msg ) )
+                impl->timestampInput();
+
+            if ( impl->isRecordingInput() )
+                impl->recordMessage( msg, wParam, lParam );
+        }
+    }
+
+    return ::DefWindowProcA( hwnd, msg, wParam, lParam );
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -283,11 +562,14 @@ void EmbeddedWindowImplWin32::processTimerExpiry(HWND hwnd, UINT wmTimerMsg, UIN
     std::ignore = wmTimerMsg;
     std::ignore = currentSysTime;
 
-    auto it = smWndMap.find( hwnd );
-    if ( it != smWndMap.end() )
+    // the gaps between these are the timer's delivery jitter
+    TRACE_SCOPE( "processTimerExpiry" );
+
+    auto * impl = static_cast< EmbeddedWindowImplWin32 * >( ::GetProp( hwnd, smInstanceProperty ) );
+    if ( impl != nullptr )
     {
         // notify that a frame is ready to be processed
-        it->second->m_observer( E_FrameReady );
+        impl->m_observer( E_FrameReady );
     }
     else
     {
@@ -299,7 +581,14 @@ void EmbeddedWindowImplWin32::processTimerExpiry(HWND hwnd, UINT wmTimerMsg, UIN
 }
 
 /////////////////////////////////////////////////////////////////////////////
-// PRIVATE NESTED, STATIC PUBLIC
+// NESTED, STATIC PUBLIC
+HINSTANCE EmbeddedWindowImplWin32::Win32Helper::getModuleInstance()
+{
+    return hImageBaseInstance;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// NESTED, STATIC PUBLIC
 std::string EmbeddedWindowImplWin32::Win32Helper::createUniqueName()
 {
     UUID       uuid;
@@ -307,13 +596,15 @@ std::string EmbeddedWindowImplWin32::Win32Helper::createUniqueName()
 
     if (rpcStatus == RPC_S_OK)
     {
-        char* cszUuid = nullptr;
-        const auto uuidToStringStatus = ::UuidToString(&uuid, (PTR_RPC_STR)&cszUuid);
+        // always the narrow version. with UNICODE the wide string used to be
+        // read as a narrow one, which cut every name down to a single character
+        RPC_CSTR cszUuid = nullptr;
+        const auto uuidToStringStatus = ::UuidToStringA(&uuid, &cszUuid);
         if (uuidToStringStatus == RPC_S_OK && cszUuid != nullptr)
         {
             // copy the UUID string before releasing the RPC buffer
-            std::string str(::_strdup(cszUuid));
-            ::RpcStringFree((PTR_RPC_STR)&cszUuid);
+            std::string str(reinterpret_cast< const char * >(cszUuid));
+            ::RpcStringFreeA(&cszUuid);
             return str;
         }
         else
@@ -326,7 +617,7 @@ std::string EmbeddedWindowImplWin32::Win32Helper::createUniqueName()
 }
 
 /////////////////////////////////////////////////////////////////////////////
-// PRIVATE NESTED, STATIC PUBLIC
+// NESTED, STATIC PUBLIC
 sf::Vector2u EmbeddedWindowImplWin32::Win32Helper::getWin32WindowSize(sf::WindowHandle hwnd)
 {
     RECT frame {};
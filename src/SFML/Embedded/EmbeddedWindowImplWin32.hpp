@@ -6,22 +6,14 @@
 
 #include <Windows.h>
 
-#include <atomic>
+#include <mutex>
 #include <string>
-#include <functional>
-#include <unordered_map>
 
 #include <SFML/Window/WindowHandle.hpp>
 #include <SFML/System/Vector2.hpp>
 
 #include "EmbeddedWindowImpl.hpp"
 
-#ifdef UNICODE
-using PTR_STR = LPCWSTR;
-#else
-using PTR_STR = LPCSTR;
-#endif
-
 namespace sf::priv
 {
 
@@ -37,19 +29,33 @@ class EmbeddedWindowImplWin32 : public sf::priv::EmbeddedWindowImpl
     ////////////////////////////////////////////////////////////////////////////////
     struct Win32WinInternals
     {
-        std::string classname;                   // WNDCLASS classname. must be unique.
+        std::string classname;                   // WNDCLASS classname. shared by the module's instances
         std::string windowname;                  //
         sf::WindowHandle parentHwnd { nullptr }; // Parent HWND of the child HWND
         sf::WindowHandle childHwnd { nullptr };  // HWND to the child
         UINT_PTR timerResult { 0 };              // timer id
     };
 
+public:
+
     ////////////////////////////////////////////////////////////////////////////////
-    /// WIN32 WINDOW HELPER
+    /// WIN32 WINDOW HELPER. also used by the remote window classes
     ////////////////////////////////////////////////////////////////////////////////
     class Win32Helper
     {
     public:
+        ////////////////////////////////////////////////////////////
+        /// \brief Gets the instance of the module this code lives in
+        ///
+        /// Window classes are registered against it rather than the
+        /// executable, so that copies of the library loaded by different
+        /// modules never share or unregister each other's classes
+        ///
+        /// \return instance handle of the containing module
+        ///
+        ////////////////////////////////////////////////////////////
+        static HINSTANCE getModuleInstance();
+
         ////////////////////////////////////////////////////////////
         /// \brief Creates a unique name by requesting a Uuid from the OS
         ///
@@ -82,7 +88,7 @@ public:
     /// \param observer callback related to state of native window
     ////////////////////////////////////////////////////////////
     EmbeddedWindowImplWin32(sf::WindowHandle parentHandle,
-                            const std::function< void( E_EmbeddedWindowEventState ) >& observer );
+                            const EmbeddedWindowObserver& observer );
 
     ////////////////////////////////////////////////////////////
     /// \brief Destructor
@@ -111,6 +117,29 @@ public:
     [[nodiscard]]
     sf::Vector2i getCursorPosition() const override;
 
+    bool postSyntheticInput() override;
+
+    bool replayInput( const EmbeddedRecordedInput& input ) override;
+
+    [[nodiscard]]
+    bool canRecordInput() const override { return true; }
+
+    [[nodiscard]]
+    bool canTimestampInput() const override { return true; }
+
+    bool setHostDriven( bool isHostDriven ) override;
+
+    bool processPending() override;
+
+    bool resizeSoftwareFramebuffer( const sf::Vector2u& size ) override;
+
+    [[nodiscard]]
+    EmbeddedSoftwareCanvas getSoftwareCanvas() override;
+
+    void presentSoftwareFramebuffer() override;
+
+    void releaseSoftwareFramebuffer() override;
+
 private:
 
     /////////////////////////////////////////////////////////////////////////////
@@ -126,9 +155,31 @@ private:
     /////////////////////////////////////////////////////////////////////////////
     bool registerWindowClass();
 
+    /////////////////////////////////////////////////////////////////////////////
+    void unregisterWindowClass();
+
     /////////////////////////////////////////////////////////////////////////////
     bool startMessagePump();
 
+    /////////////////////////////////////////////////////////////////////////////
+    void stopMessagePump();
+
+    /////////////////////////////////////////////////////////////////////////////
+    /// INPUT
+    /////////////////////////////////////////////////////////////////////////////
+
+    /////////////////////////////////////////////////////////////////////////////
+    static bool isInputMessage( UINT msg );
+
+    /////////////////////////////////////////////////////////////////////////////
+    void timestampInput();
+
+    /////////////////////////////////////////////////////////////////////////////
+    static bool isRecordedMessage( UINT msg );
+
+    /////////////////////////////////////////////////////////////////////////////
+    void recordMessage( UINT msg, WPARAM wParam, LPARAM lParam );
+
     /////////////////////////////////////////////////////////////////////////////
     /// WINAPI CALLBACKS
     /////////////////////////////////////////////////////////////////////////////
@@ -147,17 +198,34 @@ private:
 
 private:
 
-    std::function<void(E_EmbeddedWindowEventState)> m_observer;
+    EmbeddedWindowObserver m_observer;
 
     // holds Win32 window specifics
     Win32WinInternals m_win32;
 
-    // required for timer callbacks across multiple instances
-    // each child HWND is mapped to Win32SfmlWindow instance
-    inline static std::unordered_map< HWND, EmbeddedWindowImplWin32 * > smWndMap {};
-
-    // usually starts at 5 and goes up
-    inline static std::atomic< uint32_t > smTimerIdCounter { 5 };
+    // the host's loop calls processPending instead of the timer running
+    bool m_isHostDriven { false };
+
+    // framebuffer of software frames. a top-down DIB section, so the canvas
+    // draws straight into the bitmap that gets blitted
+    HDC m_softwareDc { nullptr };
+    HBITMAP m_softwareBitmap { nullptr };
+    HGDIOBJ m_previousBitmap { nullptr };
+    void * m_softwarePixels { nullptr };
+    sf::Vector2u m_softwareSize;
+
+    // timer ids are per window, so every window can use the same one
+    static constexpr UINT_PTR FrameTimerId = 1;
+
+    // window property that leads callbacks back to the instance. SFML
+    // already uses GWLP_USERDATA of the windows it attaches to
+    inline static const TCHAR * smInstanceProperty = TEXT( "sfml-embedded-window" );
+
+    // the window class is registered with the first instance and
+    // unregistered with the last one
+    inline static std::mutex smClassMutex;
+    inline static uint32_t smClassUsers { 0 };
+    inline static std::string smClassname;
 };
 
 }
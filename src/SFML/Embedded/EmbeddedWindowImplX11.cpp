@@ -0,0 +1,1025 @@
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+
+#include "EmbeddedWindowImplX11.hpp"
+#include "SFML/Embedded/EmbeddedLogger.hpp"
+#include "SFML/Embedded/EmbeddedTracer.hpp"
+#include "SFML/Embedded/EmbeddedDiagnostics.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <tuple>
+
+#include <cstdlib>
+
+#include <poll.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <X11/extensions/Xpresent.h>
+#include <X11/extensions/XInput2.h>
+
+namespace
+{
+
+// recorded input keeps the XInput2 event types, which match the core ones replays are sent as
+static_assert( XI_KeyPress == KeyPress && XI_KeyRelease == KeyRelease &&
+               XI_ButtonPress == ButtonPress && XI_ButtonRelease == ButtonRelease &&
+               XI_Motion == MotionNotify && XI_Enter == EnterNotify && XI_Leave == LeaveNotify &&
+               XI_FocusIn == FocusIn && XI_FocusOut == FocusOut,
+               "XInput2 event types must match the core ones" );
+
+////////////////////////////////////////////////////////////
+uint64_t packInput( unsigned int low, unsigned int high )
+{
+    return static_cast< uint64_t >( low ) | ( static_cast< uint64_t >( high ) << 32 );
+}
+
+////////////////////////////////////////////////////////////
+int64_t packPosition( double x, double y )
+{
+    return static_cast< int64_t >( packInput( static_cast< unsigned int >( static_cast< int >( x ) ),
+                                              static_cast< unsigned int >( static_cast< int >( y ) ) ) );
+}
+
+////////////////////////////////////////////////////////////
+// the state field of a core event: modifiers, then buttons 1 to 5
+unsigned int getCoreState( const ::XIModifierState& mods, const ::XIButtonState& buttons )
+{
+    auto state = static_cast< unsigned int >( mods.effective ) & 0xFF;
+
+    for ( int button = 1; button <= 5; ++button )
+    {
+        if ( button < buttons.mask_len * 8 && XIMaskIsSet( buttons.mask, button ) )
+            state |= Button1Mask << ( button - 1 );
+    }
+
+    return state;
+}
+
+}
+
+namespace sf::priv
+{
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+EmbeddedWindowImplX11::EmbeddedWindowImplX11(sf::WindowHandle parentHandle,
+                                             const EmbeddedWindowObserver& observer)
+    : m_observer( observer )
+{
+    TRACE_SCOPE( "create child window" );
+
+    // Xlib is called from the frame thread as well as this one, which it
+    // only allows once XInitThreads has run. that has to be before the
+    // process opens any connection, see EmbeddedWindow
+    std::call_once( smThreadsInitialized, []
+    {
+        if ( !::XInitThreads() )
+            LOG_ERROR( "failed to make Xlib thread safe" );
+    } );
+
+    if ( !createChildWindow( static_cast< ::Window >( parentHandle ) ) )
+    {
+        // notify that an error has occurred
+        m_observer( E_Error );
+        LOG_ERROR( "failed to create child window" );
+    }
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+EmbeddedWindowImplX11::~EmbeddedWindowImplX11()
+{
+    TRACE_SCOPE( "destroy child window" );
+
+    // the frame thread hands the GL context back on its way out
+    stopFrames();
+
+    releaseSoftwareFramebuffer();
+
+    if ( m_child != 0 )
+    {
+        // notify that window is about to be destroyed
+        m_observer( E_WindowDestroyed );
+
+        // SFML doesn't destroy windows it didn't create
+        ::XDestroyWindow( m_display, m_child );
+        ::XSync( m_display, False );
+        EmbeddedDiagnostics::release( E_ResourceNativeWindow );
+
+        m_child = 0;
+    }
+
+    if ( m_display != nullptr )
+    {
+        if ( m_gc != nullptr )
+            ::XFreeGC( m_display, m_gc );
+
+        ::XCloseDisplay( m_display );
+        m_display = nullptr;
+    }
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+sf::WindowHandle EmbeddedWindowImplX11::getNativeHandle() const
+{
+    return m_child;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+sf::WindowHandle EmbeddedWindowImplX11::getParentNativeHandle() const
+{
+    return m_parent;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+sf::Vector2u EmbeddedWindowImplX11::getParentWindowSize() const
+{
+    std::unique_lock< std::mutex > lock( m_displayMutex );
+
+    ::XWindowAttributes attributes {};
+    if ( m_display == nullptr || !::XGetWindowAttributes( m_display, m_parent, &attributes ) )
+    {
+        LOG_ERROR( "failed to obtain parent window size" );
+        return {};
+    }
+
+    return { static_cast< unsigned int >( attributes.width ),
+             static_cast< unsigned int >( attributes.height ) };
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+uint32_t EmbeddedWindowImplX11::getPollRateInMS() const
+{
+    return std::max< uint32_t >( 1, m_frameIntervalInUS.load( std::memory_order_relaxed ) / 1000 );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+sf::Vector2i EmbeddedWindowImplX11::getRelativeWindowPosition() const
+{
+    std::unique_lock< std::mutex > lock( m_displayMutex );
+
+    ::XWindowAttributes attributes {};
+    if ( m_display == nullptr || !::XGetWindowAttributes( m_display, m_child, &attributes ) )
+    {
+        LOG_ERROR( "failed to get window position" );
+        return { -1, -1 };
+    }
+
+    return { attributes.x, attributes.y };
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+sf::Vector2i EmbeddedWindowImplX11::getCursorPosition() const
+{
+    std::unique_lock< std::mutex > lock( m_displayMutex );
+
+    ::Window root = 0;
+    ::Window child = 0;
+    int rootX = 0;
+    int rootY = 0;
+    int x = 0;
+    int y = 0;
+    unsigned int buttons = 0;
+
+    if ( m_display != nullptr )
+        ::XQueryPointer( m_display, m_child, &root, &child, &rootX, &rootY, &x, &y, &buttons );
+
+    return { x, y };
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+bool EmbeddedWindowImplX11::hasFrameThread() const
+{
+    return !m_isHostDriven;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+bool EmbeddedWindowImplX11::isOnFrameThread() const
+{
+    return m_frameThread.get_id() == std::this_thread::get_id();
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedWindowImplX11::startFrames()
+{
+    if ( m_child == 0 || m_isHostDriven || m_frameThread.joinable() )
+        return;
+
+    m_isRunning.store( true, std::memory_order_release );
+    m_frameThread = std::thread( &EmbeddedWindowImplX11::runFrameThread, this );
+    EmbeddedDiagnostics::acquire( E_ResourceTimer );
+
+    LOG_DEBUG( "started frame thread" );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+bool EmbeddedWindowImplX11::setHostDriven( bool isHostDriven )
+{
+    if ( m_child == 0 )
+        return false;
+
+    // the frame thread hands the GL context back on its way out.
+    // EmbeddedWindow starts it again once it has let go of the context
+    if ( isHostDriven )
+    {
+        stopFrames();
+
+        // the frame thread may have left a request in flight
+        std::unique_lock< std::mutex > lock( m_displayMutex );
+        requestFrame( 0 );
+    }
+
+    m_isHostDriven = isHostDriven;
+    m_nextFallbackFrame = {};
+
+    LOG_DEBUG( isHostDriven ? "frames are driven by the host" : "frames are driven by the frame thread" );
+    return true;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+int EmbeddedWindowImplX11::getPollDescriptor() const
+{
+    return m_display != nullptr ? ConnectionNumber( m_display ) : -1;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+bool EmbeddedWindowImplX11::processPending()
+{
+    if ( !m_isHostDriven || m_display == nullptr )
+        return false;
+
+    bool isFrameDue = false;
+    bool isVisible = false;
+
+    {
+        std::unique_lock< std::mutex > lock( m_displayMutex );
+        isFrameDue = processEvents();
+        isVisible = m_isMapped && !m_isObscured;
+    }
+
+    // without Present, the host's timer paces the frames
+    isFrameDue = isFallbackFrameDue( std::chrono::steady_clock::now(), isVisible ) || isFrameDue;
+    if ( !isFrameDue )
+        return false;
+
+    m_observer( E_FrameReady );
+
+    std::unique_lock< std::mutex > lock( m_displayMutex );
+    requestFrame( m_lastMsc + 1 );
+    return true;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+bool EmbeddedWindowImplX11::resizeSoftwareFramebuffer( const sf::Vector2u& size )
+{
+    releaseSoftwareFramebuffer();
+
+    std::unique_lock< std::mutex > lock( m_displayMutex );
+
+    ::XWindowAttributes attributes {};
+    if ( m_display == nullptr || !::XGetWindowAttributes( m_display, m_child, &attributes ) )
+        return false;
+
+    // the canvas draws 32-bit BGRX pixels, which is what a 24-bit true color
+    // visual uses on a little-endian machine
+    const auto * visual = attributes.visual;
+    if ( ( attributes.depth != 24 && attributes.depth != 32 ) ||
+         visual->red_mask != 0xFF0000 || visual->green_mask != 0x00FF00 || visual->blue_mask != 0x0000FF ||
+         ::XImageByteOrder( m_display ) != LSBFirst )
+    {
+        LOG_ERROR( "software frames need a 24-bit BGRX visual" );
+        return false;
+    }
+
+    if ( m_gc == nullptr )
+        m_gc = ::XCreateGC( m_display, m_child, 0, nullptr );
+
+    if ( !createSharedImage( attributes.visual, attributes.depth, size ) )
+    {
+        // plain XPutImage through the socket. slower, but works everywhere
+        const auto bytes = std::size_t( size.x ) * size.y * 4;
+        auto * data = static_cast< char * >( std::malloc( bytes ) );
+
+        m_softwareImage = ::XCreateImage( m_display,
+                                          attributes.visual,
+                                          static_cast< unsigned int >( attributes.depth ),
+                                          ZPixmap,
+                                          0,
+                                          data,
+                                          size.x,
+                                          size.y,
+                                          32,
+                                          0 );
+
+        if ( m_softwareImage == nullptr )
+        {
+            std::free( data );
+            LOG_ERROR( "failed to create software framebuffer" );
+            return false;
+        }
+    }
+
+    EmbeddedDiagnostics::acquire( E_ResourceSoftwareFramebuffer );
+    return true;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+EmbeddedSoftwareCanvas EmbeddedWindowImplX11::getSoftwareCanvas()
+{
+    if ( m_softwareImage == nullptr )
+        return {};
+
+    return { reinterpret_cast< uint32_t * >( m_softwareImage->data ),
+             { static_cast< unsigned int >( m_softwareImage->width ),
+               static_cast< unsigned int >( m_softwareImage->height ) },
+             static_cast< uint32_t >( m_softwareImage->bytes_per_line / 4 ) };
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedWindowImplX11::presentSoftwareFramebuffer()
+{
+    std::unique_lock< std::mutex > lock( m_displayMutex );
+
+    if ( m_softwareImage == nullptr )
+        return;
+
+    const auto width = static_cast< unsigned int >( m_softwareImage->width );
+    const auto height = static_cast< unsigned int >( m_softwareImage->height );
+
+    if ( m_isShmAttached )
+        ::XShmPutImage( m_display, m_child, m_gc, m_softwareImage, 0, 0, 0, 0, width, height, False );
+    else
+        ::XPutImage( m_display, m_child, m_gc, m_softwareImage, 0, 0, 0, 0, width, height );
+
+    // the server reads shared memory after the request returns. the next
+    // frame may only draw into it once the server is done
+    ::XSync( m_display, False );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+void EmbeddedWindowImplX11::releaseSoftwareFramebuffer()
+{
+    std::unique_lock< std::mutex > lock( m_displayMutex );
+
+    if ( m_softwareImage == nullptr )
+        return;
+
+    if ( m_isShmAttached )
+    {
+        ::XShmDetach( m_display, &m_shmInfo );
+        ::XSync( m_display, False );
+        ::shmdt( m_shmInfo.shmaddr );
+
+        // XDestroyImage would free() the shared memory
+        m_softwareImage->data = nullptr;
+        m_isShmAttached = false;
+    }
+
+    XDestroyImage( m_softwareImage );
+    m_softwareImage = nullptr;
+    m_shmInfo = {};
+
+    EmbeddedDiagnostics::release( E_ResourceSoftwareFramebuffer );
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+bool EmbeddedWindowImplX11::postSyntheticInput()
+{
+    std::unique_lock< std::mutex > lock( m_displayMutex );
+
+    ::XWindowAttributes attributes {};
+    if ( m_display == nullptr || !::XGetWindowAttributes( m_display, m_child, &attributes ) )
+        return false;
+
+    // sent to SFML's selection rather than faked with XTest, so that the
+    // real cursor stays where it is
+    ::XEvent motion {};
+    motion.xmotion.type = MotionNotify;
+    motion.xmotion.display = m_display;
+    motion.xmotion.window = m_child;
+    motion.xmotion.root = attributes.root;
+    motion.xmotion.time = CurrentTime;
+    motion.xmotion.x = attributes.width / 2;
+    motion.xmotion.y = attributes.height / 2;
+    motion.xmotion.x_root = motion.xmotion.x;
+    motion.xmotion.y_root = motion.xmotion.y;
+    motion.xmotion.is_hint = NotifyNormal;
+    motion.xmotion.same_screen = True;
+
+    if ( !::XSendEvent( m_display, m_child, False, PointerMotionMask, &motion ) )
+    {
+        LOG_ERROR( "failed to post synthetic input" );
+        return false;
+    }
+
+    // XInput2 doesn't see sent events. without an event mask, a sent event
+    // goes to the window's creator, which is this connection. it is read
+    // (and timestamped) behind the motion, as the motion's XInput2 event would be
+    ::XEvent notice {};
+    notice.xclient.type = ClientMessage;
+    notice.xclient.display = m_display;
+    notice.xclient.window = m_child;
+    notice.xclient.message_type = m_syntheticInputAtom;
+    notice.xclient.format = 32;
+
+    ::XSendEvent( m_display, m_child, False, NoEventMask, &notice );
+    ::XFlush( m_display );
+    return true;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+bool EmbeddedWindowImplX11::replayInput( const EmbeddedRecordedInput& input )
+{
+    // anything else could make the window do what no user input does
+    if ( !EmbeddedInputRecording::isRecordedMessage( input.message ) )
+    {
+        LOG_WARN( "not replaying message {}, which isn't input", input.message );
+        return false;
+    }
+
+    std::unique_lock< std::mutex > lock( m_displayMutex );
+    if ( m_display == nullptr )
+        return false;
+
+    const auto detail = static_cast< unsigned int >( input.wParam & 0xFFFFFFFF );
+    const auto extra = static_cast< unsigned int >( input.wParam >> 32 );
+    const auto x = static_cast< int >( static_cast< int32_t >( input.lParam & 0xFFFFFFFF ) );
+    const auto y = static_cast< int >( static_cast< int32_t >( static_cast< uint64_t >( input.lParam ) >> 32 ) );
+    const auto root = DefaultRootWindow( m_display );
+
+    // SFML only reads the window relative positions, so the root ones are
+    // left relative to the window as well
+    ::XEvent event {};
+    long mask = NoEventMask;
+
+    switch ( input.message )
+    {
+        case KeyPress:
+        case KeyRelease:
+            event.xkey.type = static_cast< int >( input.message );
+            event.xkey.display = m_display;
+            event.xkey.window = m_child;
+            event.xkey.root = root;
+            event.xkey.time = CurrentTime;
+            event.xkey.x = event.xkey.x_root = x;
+            event.xkey.y = event.xkey.y_root = y;
+            event.xkey.state = extra;
+            event.xkey.keycode = detail;
+            event.xkey.same_screen = True;
+            mask = input.message == KeyPress ? KeyPressMask : KeyReleaseMask;
+            break;
+
+        case ButtonPress:
+        case ButtonRelease:
+            event.xbutton.type = static_cast< int >( input.message );
+            event.xbutton.display = m_display;
+            event.xbutton.window = m_child;
+            event.xbutton.root = root;
+            event.xbutton.time = CurrentTime;
+            event.xbutton.x = event.xbutton.x_root = x;
+            event.xbutton.y = event.xbutton.y_root = y;
+            event.xbutton.state = extra;
+            event.xbutton.button = detail;
+            event.xbutton.same_screen = True;
+            mask = input.message == ButtonPress ? ButtonPressMask : ButtonReleaseMask;
+            break;
+
+        case MotionNotify:
+            event.xmotion.type = MotionNotify;
+            event.xmotion.display = m_display;
+            event.xmotion.window = m_child;
+            event.xmotion.root = root;
+            event.xmotion.time = CurrentTime;
+            event.xmotion.x = event.xmotion.x_root = x;
+            event.xmotion.y = event.xmotion.y_root = y;
+            event.xmotion.state = extra;
+            event.xmotion.is_hint = NotifyNormal;
+            event.xmotion.same_screen = True;
+            mask = PointerMotionMask;
+            break;
+
+        case EnterNotify:
+        case LeaveNotify:
+            event.xcrossing.type = static_cast< int >( input.message );
+            event.xcrossing.display = m_display;
+            event.xcrossing.window = m_child;
+            event.xcrossing.root = root;
+            event.xcrossing.time = CurrentTime;
+            event.xcrossing.x = event.xcrossing.x_root = x;
+            event.xcrossing.y = event.xcrossing.y_root = y;
+            event.xcrossing.detail = static_cast< int >( detail );
+            event.xcrossing.mode = static_cast< int >( extra );
+            event.xcrossing.same_screen = True;
+            mask = input.message == EnterNotify ? EnterWindowMask : LeaveWindowMask;
+            break;
+
+        default:
+            event.xfocus.type = static_cast< int >( input.message );
+            event.xfocus.display = m_display;
+            event.xfocus.window = m_child;
+            event.xfocus.detail = static_cast< int >( detail );
+            event.xfocus.mode = static_cast< int >( extra );
+            mask = FocusChangeMask;
+            break;
+    }
+
+    ::XSendEvent( m_display, m_child, False, mask, &event );
+
+    // once the server answers, the event is on SFML's connection, where the
+    // frame that replays it polls
+    ::XSync( m_display, False );
+    return true;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+bool EmbeddedWindowImplX11::canRecordInput() const
+{
+    return m_inputOpcode >= 0;
+}
+
+////////////////////////////////////////////////////////////
+// PUBLIC
+bool EmbeddedWindowImplX11::canTimestampInput() const
+{
+    return m_inputOpcode >= 0;
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+bool EmbeddedWindowImplX11::createChildWindow( ::Window parent )
+{
+    m_parent = parent;
+
+    m_display = ::XOpenDisplay( nullptr );
+    if ( m_display == nullptr )
+    {
+        LOG_ERROR( "failed to open X display" );
+        return false;
+    }
+
+    ::XWindowAttributes parentAttributes {};
+    if ( !::XGetWindowAttributes( m_display, m_parent, &parentAttributes ) )
+    {
+        LOG_ERROR( "failed to obtain parent window attributes" );
+        return false;
+    }
+
+    // the structure and visibility events tell when frames are worth rendering.
+    // unlike button presses, any number of clients may select them
+    ::XSetWindowAttributes attributes {};
+    attributes.event_mask = StructureNotifyMask | VisibilityChangeMask;
+
+    m_child = ::XCreateWindow( m_display,
+                               m_parent,
+                               0,
+                               0,
+                               static_cast< unsigned int >( std::max( 1, parentAttributes.width ) ),
+                               static_cast< unsigned int >( std::max( 1, parentAttributes.height ) ),
+                               0,
+                               CopyFromParent,
+                               InputOutput,
+                               CopyFromParent,
+                               CWEventMask,
+                               &attributes );
+
+    if ( m_child == 0 )
+    {
+        LOG_ERROR( "failed to create child window" );
+        return false;
+    }
+
+    EmbeddedDiagnostics::acquire( E_ResourceNativeWindow );
+
+    if ( !selectPresentEvents() )
+        LOG_WARN( "Present extension not available. frames fall back to a fixed rate" );
+
+    if ( !selectInputEvents() )
+        LOG_WARN( "XInput2 not available. input isn't timestamped or recorded" );
+
+    m_syntheticInputAtom = ::XInternAtom( m_display, "SFML_EMBEDDED_SYNTHETIC_INPUT", False );
+
+    ::XMapWindow( m_display, m_child );
+
+    // SFML attaches through its own connection, which must already know the window
+    ::XSync( m_display, False );
+
+    m_observer( E_WindowCreated );
+    return true;
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+bool EmbeddedWindowImplX11::selectPresentEvents()
+{
+    int eventBase = 0;
+    int errorBase = 0;
+
+    if ( !::XPresentQueryExtension( m_display, &m_presentOpcode, &eventBase, &errorBase ) )
+    {
+        m_presentOpcode = -1;
+        return false;
+    }
+
+    ::XPresentSelectInput( m_display, m_child, PresentCompleteNotifyMask );
+    return true;
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+bool EmbeddedWindowImplX11::createSharedImage( ::Visual * visual, int depth, const sf::Vector2u& size )
+{
+    if ( !::XShmQueryExtension( m_display ) )
+        return false;
+
+    m_softwareImage = ::XShmCreateImage( m_display,
+                                         visual,
+                                         static_cast< unsigned int >( depth ),
+                                         ZPixmap,
+                                         nullptr,
+                                         &m_shmInfo,
+                                         size.x,
+                                         size.y );
+    if ( m_softwareImage == nullptr )
+        return false;
+
+    const auto bytes = std::size_t( m_softwareImage->bytes_per_line ) * size.y;
+    m_shmInfo.shmid = ::shmget( IPC_PRIVATE, bytes, IPC_CREAT | 0600 );
+    m_shmInfo.shmaddr = m_shmInfo.shmid < 0 ? reinterpret_cast< char * >( -1 )
+                                            : static_cast< char * >( ::shmat( m_shmInfo.shmid, nullptr, 0 ) );
+
+    if ( m_shmInfo.shmaddr == reinterpret_cast< char * >( -1 ) )
+    {
+        LOG_WARN( "unable to allocate shared memory for software frames" );
+        if ( m_shmInfo.shmid >= 0 )
+            ::shmctl( m_shmInfo.shmid, IPC_RMID, nullptr );
+
+        XDestroyImage( m_softwareImage );
+        m_softwareImage = nullptr;
+        m_shmInfo = {};
+        return false;
+    }
+
+    m_softwareImage->data = m_shmInfo.shmaddr;
+    m_shmInfo.readOnly = False;
+
+    // the server can't attach over a remote connection, and reports that
+    // with an X error. catch it rather than let the default handler exit
+    smShmAttachFailed = false;
+    auto * previousHandler = ::XSetErrorHandler( &EmbeddedWindowImplX11::handleShmAttachError );
+    ::XShmAttach( m_display, &m_shmInfo );
+    ::XSync( m_display, False );
+    ::XSetErrorHandler( previousHandler );
+
+    // removed once both sides detach, even if the process crashes
+    ::shmctl( m_shmInfo.shmid, IPC_RMID, nullptr );
+
+    if ( smShmAttachFailed )
+    {
+        LOG_WARN( "unable to share memory with the X server. software frames go through the socket" );
+        ::shmdt( m_shmInfo.shmaddr );
+        m_softwareImage->data = nullptr;
+        XDestroyImage( m_softwareImage );
+        m_softwareImage = nullptr;
+        m_shmInfo = {};
+        return false;
+    }
+
+    m_isShmAttached = true;
+    return true;
+}
+
+////////////////////////////////////////////////////////////
+// STATIC PRIVATE
+int EmbeddedWindowImplX11::handleShmAttachError( ::Display * display, ::XErrorEvent * error )
+{
+    std::ignore = display;
+    std::ignore = error;
+
+    smShmAttachFailed = true;
+    return 0;
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+bool EmbeddedWindowImplX11::selectInputEvents()
+{
+    int eventBase = 0;
+    int errorBase = 0;
+
+    if ( !::XQueryExtension( m_display, "XInputExtension", &m_inputOpcode, &eventBase, &errorBase ) )
+    {
+        m_inputOpcode = -1;
+        return false;
+    }
+
+    // 2.0 keeps the wheel as buttons 4 to 7, as SFML sees it
+    int major = 2;
+    int minor = 0;
+    if ( ::XIQueryVersion( m_display, &major, &minor ) != Success )
+    {
+        m_inputOpcode = -1;
+        return false;
+    }
+
+    unsigned char bits[ XIMaskLen( XI_LASTEVENT ) ] {};
+    for ( const auto type : { XI_KeyPress, XI_KeyRelease, XI_ButtonPress, XI_ButtonRelease, XI_Motion,
+                              XI_Enter, XI_Leave, XI_FocusIn, XI_FocusOut } )
+        XISetMask( bits, type );
+
+    ::XIEventMask mask { XIAllMasterDevices, static_cast< int >( sizeof( bits ) ), bits };
+
+    // another XInput2 client may already have selected the button presses
+    smInputSelectFailed = false;
+    auto * previousHandler = ::XSetErrorHandler( &EmbeddedWindowImplX11::handleInputSelectError );
+    ::XISelectEvents( m_display, m_child, &mask, 1 );
+    ::XSync( m_display, False );
+    ::XSetErrorHandler( previousHandler );
+
+    if ( smInputSelectFailed )
+    {
+        m_inputOpcode = -1;
+        return false;
+    }
+
+    return true;
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+void EmbeddedWindowImplX11::processInputEvent( const ::XGenericEventCookie& cookie )
+{
+    switch ( cookie.evtype )
+    {
+        case XI_KeyPress:
+        case XI_KeyRelease:
+        case XI_ButtonPress:
+        case XI_ButtonRelease:
+        case XI_Motion:
+        {
+            const auto& device = *static_cast< const ::XIDeviceEvent * >( cookie.data );
+            timestampInput( device.time );
+
+            recordInput( { static_cast< uint32_t >( cookie.evtype ),
+                           packInput( static_cast< unsigned int >( device.detail ), getCoreState( device.mods, device.buttons ) ),
+                           packPosition( device.event_x, device.event_y ) } );
+            break;
+        }
+
+        case XI_Enter:
+        case XI_Leave:
+        case XI_FocusIn:
+        case XI_FocusOut:
+        {
+            // focus changes have no position that means anything
+            const auto& crossing = *static_cast< const ::XIEnterEvent * >( cookie.data );
+            const bool isFocus = cookie.evtype == XI_FocusIn || cookie.evtype == XI_FocusOut;
+
+            recordInput( { static_cast< uint32_t >( cookie.evtype ),
+                           packInput( static_cast< unsigned int >( crossing.detail ), static_cast< unsigned int >( crossing.mode ) ),
+                           isFocus ? 0 : packPosition( crossing.event_x, crossing.event_y ) } );
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+void EmbeddedWindowImplX11::timestampInput( ::Time serverTime )
+{
+    if ( !isTimestampingInput() )
+        return;
+
+    // the event may have waited on the connection for a while (during a
+    // long frame, say), so date it back to when the server sent it. server
+    // times are milliseconds on a clock of their own, so only how much
+    // longer this event took than the quickest one so far is known
+    const auto now = InputClock::now();
+    const auto localTime = static_cast< uint32_t >(
+        std::chrono::duration_cast< std::chrono::milliseconds >( now.time_since_epoch() ).count() );
+
+    const auto difference = localTime - static_cast< uint32_t >( serverTime );
+    auto queuedInMS = difference - m_serverTimeBase;
+
+    // wrapped around: quicker than any event so far
+    if ( !m_hasServerTimeBase || queuedInMS > UINT32_MAX / 2 )
+    {
+        m_serverTimeBase = difference;
+        m_hasServerTimeBase = true;
+        queuedInMS = 0;
+    }
+
+    recordInputArrival( now - std::chrono::milliseconds( std::min< uint32_t >( queuedInMS, 1000 ) ) );
+}
+
+////////////////////////////////////////////////////////////
+// STATIC PRIVATE
+int EmbeddedWindowImplX11::handleInputSelectError( ::Display * display, ::XErrorEvent * error )
+{
+    std::ignore = display;
+    std::ignore = error;
+
+    smInputSelectFailed = true;
+    return 0;
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+void EmbeddedWindowImplX11::stopFrames()
+{
+    if ( !m_frameThread.joinable() )
+        return;
+
+    m_isRunning.store( false, std::memory_order_release );
+    m_frameThread.join();
+    EmbeddedDiagnostics::release( E_ResourceTimer );
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+void EmbeddedWindowImplX11::runFrameThread()
+{
+    TRACE_THREAD_NAME( "x11 frames" );
+
+    using Clock = std::chrono::steady_clock;
+    m_nextFallbackFrame = Clock::now();
+
+    {
+        // asks for the current MSC, which completes right away
+        std::unique_lock< std::mutex > lock( m_displayMutex );
+        requestFrame( 0 );
+    }
+
+    while ( m_isRunning.load( std::memory_order_acquire ) )
+    {
+        bool isFrameDue = false;
+        bool isVisible = false;
+
+        {
+            std::unique_lock< std::mutex > lock( m_displayMutex );
+            isFrameDue = processEvents();
+            isVisible = m_isMapped && !m_isObscured;
+        }
+
+        const auto now = Clock::now();
+        isFrameDue = isFallbackFrameDue( now, isVisible ) || isFrameDue;
+
+        if ( isFrameDue )
+        {
+            m_observer( E_FrameReady );
+
+            // the next one is requested once this one is done, so a slow frame
+            // skips vertical blanks rather than queueing them up
+            std::unique_lock< std::mutex > lock( m_displayMutex );
+            requestFrame( m_lastMsc + 1 );
+            continue;
+        }
+
+        // wait for the server. the timeout only bounds how late a stop is seen
+        auto timeoutInMS = StopCheckIntervalInMS;
+        if ( m_presentOpcode < 0 && isVisible )
+        {
+            const auto untilFrame = std::chrono::duration_cast< std::chrono::milliseconds >( m_nextFallbackFrame - now );
+            timeoutInMS = std::clamp( static_cast< int >( untilFrame.count() ), 0, FallbackFrameIntervalInMS );
+        }
+
+        ::pollfd connection { ConnectionNumber( m_display ), POLLIN, 0 };
+        ::poll( &connection, 1, timeoutInMS );
+    }
+
+    // hand the GL context back before the thread goes away
+    m_observer( E_FramesStopped );
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+bool EmbeddedWindowImplX11::processEvents()
+{
+    bool isFrameDue = false;
+
+    while ( ::XPending( m_display ) > 0 )
+    {
+        ::XEvent event {};
+        ::XNextEvent( m_display, &event );
+
+        switch ( event.type )
+        {
+            case MapNotify:
+                m_isMapped = true;
+                break;
+
+            case UnmapNotify:
+                m_isMapped = false;
+                break;
+
+            case VisibilityNotify:
+                m_isObscured = event.xvisibility.state == VisibilityFullyObscured;
+                break;
+
+            case ClientMessage:
+                // a synthetic input, read right behind the motion SFML gets
+                if ( event.xclient.message_type == m_syntheticInputAtom )
+                    recordInputArrival( InputClock::now() );
+                break;
+
+            case GenericEvent:
+            {
+                auto& cookie = event.xcookie;
+                const bool isInput = m_inputOpcode >= 0 && cookie.extension == m_inputOpcode;
+                if ( ( cookie.extension != m_presentOpcode && !isInput ) || !::XGetEventData( m_display, &cookie ) )
+                    break;
+
+                if ( isInput )
+                    processInputEvent( cookie );
+                else if ( cookie.evtype == PresentCompleteNotify )
+                {
+                    const auto * complete = static_cast< const XPresentCompleteNotifyEvent * >( cookie.data );
+                    if ( complete->kind == PresentCompleteKindNotifyMSC )
+                    {
+                        m_isFrameRequested = false;
+                        updateFrameInterval( complete->ust, complete->msc );
+
+                        // the window may have been hidden since the request
+                        isFrameDue = m_isMapped && !m_isObscured;
+                    }
+                }
+
+                ::XFreeEventData( m_display, &cookie );
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+
+    // nothing is requested while hidden. start again once visible
+    if ( !isFrameDue )
+        requestFrame( 0 );
+
+    return isFrameDue;
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+bool EmbeddedWindowImplX11::isFallbackFrameDue( std::chrono::steady_clock::time_point now, bool isVisible )
+{
+    if ( m_presentOpcode >= 0 || !isVisible || now < m_nextFallbackFrame )
+        return false;
+
+    m_nextFallbackFrame = now + std::chrono::milliseconds( FallbackFrameIntervalInMS );
+    return true;
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+void EmbeddedWindowImplX11::requestFrame( uint64_t targetMsc )
+{
+    if ( m_presentOpcode < 0 || m_isFrameRequested || !m_isMapped || m_isObscured )
+        return;
+
+    // completes at targetMsc, or right away if that has already passed
+    ::XPresentNotifyMSC( m_display, m_child, ++m_presentSerial, targetMsc, 0, 0 );
+    ::XFlush( m_display );
+    m_isFrameRequested = true;
+}
+
+////////////////////////////////////////////////////////////
+// PRIVATE
+void EmbeddedWindowImplX11::updateFrameInterval( uint64_t ust, uint64_t msc )
+{
+    if ( m_lastMsc != 0 && msc > m_lastMsc && ust > m_lastUst )
+    {
+        const auto interval = ( ust - m_lastUst ) / ( msc - m_lastMsc );
+        m_frameIntervalInUS.store( static_cast< uint32_t >( std::min< uint64_t >( interval, 1000000 ) ),
+                                   std::memory_order_relaxed );
+    }
+
+    m_lastUst = ust;
+    m_lastMsc = msc;
+}
+
+}
@@ -0,0 +1,250 @@
+#pragma once
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+#include <SFML/Window/WindowHandle.hpp>
+#include <SFML/System/Vector2.hpp>
+
+#include "EmbeddedWindowImpl.hpp"
+
+namespace sf::priv
+{
+
+////////////////////////////////////////////////////////////
+/// \brief X11 implementation of EmbeddedWindowImpl
+///
+/// Frames are paced by the Present extension rather than a timer: every
+/// frame asks for a notification at the next vertical blank, so frames
+/// are rendered exactly as often as they can be shown. Under XWayland
+/// those notifications follow the Wayland compositor's frame callbacks.
+/// No frames are requested while the window is unmapped or fully
+/// obscured. Without Present, frames fall back to a fixed rate.
+///
+/// The notifications arrive on a connection of our own, which a frame
+/// thread waits on. E_FrameReady is notified from that thread, unless the
+/// host's loop polls the connection and calls processPending instead.
+///
+/// Input is observed through XInput2 on the same connection. Unlike core
+/// button presses, which only one client can select, XInput2 events reach
+/// us as well as SFML. They are timestamped and recorded as they are read.
+/// Recorded input uses the core event types, which XInput2's match:
+///   message: KeyPress to FocusOut
+///   wParam:  keycode or button (low 32 bits), and the modifier and button
+///            state (high 32 bits). crossing and focus: detail, and mode
+///   lParam:  x (low 32 bits) and y (high 32 bits), relative to the window
+/// Replays and synthetic input are core events sent to SFML's selection
+/// with XSendEvent. Without XInput2, input isn't timestamped or recorded.
+////////////////////////////////////////////////////////////
+class EmbeddedWindowImplX11 : public sf::priv::EmbeddedWindowImpl
+{
+public:
+
+    // prevent default ctor and copying
+    EmbeddedWindowImplX11() = delete;
+    EmbeddedWindowImplX11(const EmbeddedWindowImplX11& other) = delete;
+    EmbeddedWindowImplX11& operator=(const EmbeddedWindowImplX11& other) = delete;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Construct the child window and attach it to a parent window
+    ///
+    /// \param parentHandle X11 window of the parent
+    /// \param observer callback related to state of native window
+    ////////////////////////////////////////////////////////////
+    EmbeddedWindowImplX11(sf::WindowHandle parentHandle,
+                          const EmbeddedWindowObserver& observer);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Destructor
+    ///
+    ////////////////////////////////////////////////////////////
+    ~EmbeddedWindowImplX11() override;
+
+    [[nodiscard]]
+    sf::WindowHandle getNativeHandle() const override;
+
+    [[nodiscard]]
+    sf::WindowHandle getParentNativeHandle() const override;
+
+    [[nodiscard]]
+    sf::Vector2u getParentWindowSize() const override;
+
+    [[nodiscard]]
+    uint32_t getPollRateInMS() const override;
+
+    [[nodiscard]]
+    sf::Vector2i getRelativeWindowPosition() const override;
+
+    [[nodiscard]]
+    sf::Vector2i getCursorPosition() const override;
+
+    [[nodiscard]]
+    bool hasFrameThread() const override;
+
+    [[nodiscard]]
+    bool isOnFrameThread() const override;
+
+    void startFrames() override;
+
+    bool setHostDriven( bool isHostDriven ) override;
+
+    [[nodiscard]]
+    int getPollDescriptor() const override;
+
+    bool processPending() override;
+
+    bool resizeSoftwareFramebuffer( const sf::Vector2u& size ) override;
+
+    [[nodiscard]]
+    EmbeddedSoftwareCanvas getSoftwareCanvas() override;
+
+    void presentSoftwareFramebuffer() override;
+
+    void releaseSoftwareFramebuffer() override;
+
+    bool postSyntheticInput() override;
+
+    bool replayInput( const EmbeddedRecordedInput& input ) override;
+
+    [[nodiscard]]
+    bool canRecordInput() const override;
+
+    [[nodiscard]]
+    bool canTimestampInput() const override;
+
+private:
+
+    /////////////////////////////////////////////////////////////////////////////
+    /// WINDOW CREATION AND SETUP
+    /////////////////////////////////////////////////////////////////////////////
+
+    /////////////////////////////////////////////////////////////////////////////
+    bool createChildWindow( ::Window parent );
+
+    /////////////////////////////////////////////////////////////////////////////
+    bool selectPresentEvents();
+
+    /////////////////////////////////////////////////////////////////////////////
+    void stopFrames();
+
+    /////////////////////////////////////////////////////////////////////////////
+    bool createSharedImage( ::Visual * visual, int depth, const sf::Vector2u& size );
+
+    /////////////////////////////////////////////////////////////////////////////
+    static int handleShmAttachError( ::Display * display, ::XErrorEvent * error );
+
+    /////////////////////////////////////////////////////////////////////////////
+    /// INPUT
+    /////////////////////////////////////////////////////////////////////////////
+
+    /////////////////////////////////////////////////////////////////////////////
+    bool selectInputEvents();
+
+    /////////////////////////////////////////////////////////////////////////////
+    void processInputEvent( const ::XGenericEventCookie& cookie );
+
+    /////////////////////////////////////////////////////////////////////////////
+    void timestampInput( ::Time serverTime );
+
+    /////////////////////////////////////////////////////////////////////////////
+    static int handleInputSelectError( ::Display * display, ::XErrorEvent * error );
+
+    /////////////////////////////////////////////////////////////////////////////
+    /// FRAME PACING
+    /////////////////////////////////////////////////////////////////////////////
+
+    /////////////////////////////////////////////////////////////////////////////
+    void runFrameThread();
+
+    /////////////////////////////////////////////////////////////////////////////
+    bool processEvents();
+
+    /////////////////////////////////////////////////////////////////////////////
+    bool isFallbackFrameDue( std::chrono::steady_clock::time_point now, bool isVisible );
+
+    /////////////////////////////////////////////////////////////////////////////
+    void requestFrame( uint64_t targetMsc );
+
+    /////////////////////////////////////////////////////////////////////////////
+    void updateFrameInterval( uint64_t ust, uint64_t msc );
+
+private:
+
+    // without Present, and while waiting for it to come back
+    static constexpr int FallbackFrameIntervalInMS = 16;
+
+    // how often the frame thread checks whether it should stop
+    static constexpr int StopCheckIntervalInMS = 100;
+
+    EmbeddedWindowObserver m_observer;
+
+    // our own connection. SFML uses the display's shared one
+    ::Display * m_display { nullptr };
+    ::Window m_parent { 0 };
+    ::Window m_child { 0 };
+
+    // the frame thread and the render thread both talk to the server
+    mutable std::mutex m_displayMutex;
+
+    // Present extension. -1 when the server doesn't have it
+    int m_presentOpcode { -1 };
+    uint32_t m_presentSerial { 0 };
+    bool m_isFrameRequested { false };
+
+    // frames are only requested while the window can be seen
+    bool m_isMapped { true };
+    bool m_isObscured { false };
+
+    // measured from the notifications. a guess until then
+    uint64_t m_lastUst { 0 };
+    uint64_t m_lastMsc { 0 };
+    std::atomic< uint32_t > m_frameIntervalInUS { FallbackFrameIntervalInMS * 1000 };
+
+    // without Present, frames are due at a fixed rate from here on
+    std::chrono::steady_clock::time_point m_nextFallbackFrame;
+
+    std::thread m_frameThread;
+    std::atomic< bool > m_isRunning { false };
+
+    // the host's loop calls processPending instead of the frame thread running
+    bool m_isHostDriven { false };
+
+    // XInput2. -1 when the server doesn't have it
+    int m_inputOpcode { -1 };
+
+    // the smallest difference between our clock and the server's seen so
+    // far, in milliseconds. input that took longer than that waited
+    uint32_t m_serverTimeBase { 0 };
+    bool m_hasServerTimeBase { false };
+
+    // type of the client message that tells a synthetic input was posted
+    ::Atom m_syntheticInputAtom { 0 };
+
+    // framebuffer of software frames. in shared memory with the server when
+    // MIT-SHM is there, so presenting doesn't go through the socket
+    ::XImage * m_softwareImage { nullptr };
+    ::XShmSegmentInfo m_shmInfo {};
+    bool m_isShmAttached { false };
+    ::GC m_gc { nullptr };
+
+    // set by handleShmAttachError. attaching fails on remote displays
+    inline static bool smShmAttachFailed { false };
+
+    // set by handleInputSelectError. another XInput2 client may hold the button presses
+    inline static bool smInputSelectFailed { false };
+
+    // XInitThreads runs once, before the first window opens its connection
+    inline static std::once_flag smThreadsInitialized;
+};
+
+}
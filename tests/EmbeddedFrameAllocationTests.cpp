@@ -0,0 +1,120 @@
+#include "SFML/Embedded/EmbeddedFrameArena.hpp"
+#include "SFML/Embedded/EmbeddedTaskQueue.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+
+std::atomic< bool > isCounting { false };
+std::atomic< uint64_t > allocationCount { 0 };
+
+////////////////////////////////////////////////////////////
+void * allocate( std::size_t bytes, std::size_t alignment )
+{
+  if ( isCounting.load( std::memory_order_relaxed ) )
+    allocationCount.fetch_add( 1, std::memory_order_relaxed );
+
+  bytes = bytes == 0 ? 1 : bytes;
+
+  void * ptr = alignment <= alignof( std::max_align_t )
+    ? std::malloc( bytes )
+    : std::aligned_alloc( alignment, ( bytes + alignment - 1 ) / alignment * alignment );
+
+  if ( !ptr )
+    throw std::bad_alloc();
+
+  return ptr;
+}
+
+////////////////////////////////////////////////////////////
+/// \brief Counts every global operator new while it is alive
+////////////////////////////////////////////////////////////
+class AllocationCounter
+{
+public:
+
+  AllocationCounter()
+  {
+    allocationCount.store( 0, std::memory_order_relaxed );
+    isCounting.store( true, std::memory_order_relaxed );
+  }
+
+  ~AllocationCounter() { isCounting.store( false, std::memory_order_relaxed ); }
+
+  AllocationCounter( const AllocationCounter& ) = delete;
+  AllocationCounter& operator=( const AllocationCounter& ) = delete;
+
+  uint64_t getCount() const { return allocationCount.load( std::memory_order_relaxed ); }
+};
+
+struct Vertex
+{
+  float x, y;
+  uint32_t color;
+};
+
+////////////////////////////////////////////////////////////
+/// one frame of the frame thread: run the posted tasks, build the frame's
+/// scratch data in the arena, then throw it all away
+void simulateFrame( sf::EmbeddedTaskQueue& tasks, sf::EmbeddedFrameArena& arena, uint64_t& applied )
+{
+  // what applyToFrames posts: small captures that fit the task storage
+  for ( int i = 0; i < 16; ++i )
+  {
+    uint64_t * target = &applied;
+    ASSERT_TRUE( tasks.push( [target, i]() noexcept { *target += uint64_t( i ); } ) );
+  }
+
+  ASSERT_EQ( tasks.drain( sf::seconds( 1.f ), tasks.getCapacity() ), 16u );
+
+  sf::FrameVector< Vertex > vertices( &arena );
+  for ( int i = 0; i < 600; ++i )
+    vertices.push_back( { float( i ), float( i ), 0xffffffff } );
+
+  sf::FrameString label( "parameter value that does not fit the small string buffer", &arena );
+  label += " and grows";
+
+  arena.reset();
+}
+
+}
+
+////////////////////////////////////////////////////////////
+void * operator new( std::size_t bytes ) { return allocate( bytes, alignof( std::max_align_t ) ); }
+void * operator new( std::size_t bytes, std::align_val_t alignment ) { return allocate( bytes, std::size_t( alignment ) ); }
+void operator delete( void * ptr ) noexcept { std::free( ptr ); }
+void operator delete( void * ptr, std::size_t ) noexcept { std::free( ptr ); }
+void operator delete( void * ptr, std::align_val_t ) noexcept { std::free( ptr ); }
+void operator delete( void * ptr, std::size_t, std::align_val_t ) noexcept { std::free( ptr ); }
+
+////////////////////////////////////////////////////////////
+TEST( EmbeddedFrameAllocation, WarmFramesDoNotAllocate )
+{
+  sf::EmbeddedTaskQueue tasks( 64 );
+  sf::EmbeddedFrameArena arena( 1024 );
+  uint64_t applied = 0;
+
+  // the arena grows to the frame's high water mark on the first resets
+  for ( int frame = 0; frame < 4; ++frame )
+    simulateFrame( tasks, arena, applied );
+
+  uint64_t allocations = 0;
+  {
+    AllocationCounter counter;
+
+    for ( int frame = 0; frame < 1000; ++frame )
+      simulateFrame( tasks, arena, applied );
+
+    allocations = counter.getCount();
+  }
+
+  EXPECT_EQ( allocations, 0u );
+  EXPECT_EQ( applied, 1004u * 120u );
+}
@@ -0,0 +1,118 @@
+#include "SFML/Embedded/EmbeddedFrameArena.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+
+////////////////////////////////////////////////////////////
+/// \brief Upstream resource that counts what the arena asks of the heap
+////////////////////////////////////////////////////////////
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+
+  uint64_t allocationCount { 0 };
+  uint64_t deallocationCount { 0 };
+
+protected:
+
+  void * do_allocate( std::size_t bytes, std::size_t alignment ) override
+  {
+    ++allocationCount;
+    return std::pmr::new_delete_resource()->allocate( bytes, alignment );
+  }
+
+  void do_deallocate( void * ptr, std::size_t bytes, std::size_t alignment ) override
+  {
+    ++deallocationCount;
+    std::pmr::new_delete_resource()->deallocate( ptr, bytes, alignment );
+  }
+
+  [[nodiscard]]
+  bool do_is_equal( const std::pmr::memory_resource& other ) const noexcept override
+  {
+    return this == &other;
+  }
+};
+
+////////////////////////////////////////////////////////////
+/// \brief Allocates what a typical onFrame does: a vertex list, labels and a hit-test list
+////////////////////////////////////////////////////////////
+void simulateFrame( sf::EmbeddedFrameArena& arena, std::size_t widgetCount )
+{
+  struct Vertex
+  {
+    float x, y;
+    uint32_t color;
+    float u, v;
+  };
+
+  sf::FrameVector< Vertex > vertices( &arena );
+  sf::FrameVector< const void * > hitTargets( &arena );
+
+  for ( std::size_t i = 0; i < widgetCount; ++i )
+  {
+    // grows one push at a time, like a vertex list built without reserve
+    for ( int corner = 0; corner < 6; ++corner )
+      vertices.push_back( { float( i ), float( corner ), 0xffffffff, 0.f, 0.f } );
+
+    sf::FrameString label( "parameter value that does not fit the small string buffer ", &arena );
+    label += std::to_string( i );
+
+    hitTargets.push_back( &vertices.back() );
+  }
+}
+
+}
+
+////////////////////////////////////////////////////////////
+TEST( EmbeddedFrameArena, MakesNoUpstreamAllocationsAfterWarmUp )
+{
+  CountingResource upstream;
+  sf::EmbeddedFrameArena arena( 1024, &upstream );
+
+  // the first frames overflow the small buffer, which grows on reset
+  for ( int frame = 0; frame < 4; ++frame )
+  {
+    simulateFrame( arena, 200 );
+    arena.reset();
+  }
+
+  ASSERT_GT( arena.getOverflowCount(), 0u );
+
+  const auto warmAllocations = upstream.allocationCount;
+  const auto warmOverflows = arena.getOverflowCount();
+
+  // frames of the same size, or smaller, never touch the upstream resource again
+  for ( int frame = 0; frame < 1000; ++frame )
+  {
+    simulateFrame( arena, 100 + frame % 101 );
+    arena.reset();
+  }
+
+  EXPECT_EQ( upstream.allocationCount, warmAllocations );
+  EXPECT_EQ( arena.getOverflowCount(), warmOverflows );
+}
+
+////////////////////////////////////////////////////////////
+TEST( EmbeddedFrameArena, ReturnsEverythingToUpstream )
+{
+  CountingResource upstream;
+
+  {
+    sf::EmbeddedFrameArena arena( 256, &upstream );
+
+    // the destructor also has to release overflow that was never reset
+    simulateFrame( arena, 50 );
+    arena.reset();
+    simulateFrame( arena, 500 );
+  }
+
+  EXPECT_GT( upstream.allocationCount, 1u );
+  EXPECT_EQ( upstream.allocationCount, upstream.deallocationCount );
+}